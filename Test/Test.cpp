@@ -2,8 +2,87 @@
 #include <cassert>
 #include <vector>
 #include <random>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cstdio>
+#include <new>
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
+template <size_t N>
+int TestFixed(std::ranlux48& engine)
+{
+    using namespace std;
+    for (int i = 0; i != 1000; ++i)
+    {
+        uniform_real_distribution<float> dist(-10000, 10000);
+        vector<float> source;
+        source.resize(N);
+        for (auto& e : source)
+            e = dist(engine);
+        vector<uint8_t> destination, expected;
+        destination.resize(VectorCodec::UpperBound(N));
+        expected.resize(VectorCodec::UpperBound(N));
+        auto k = VectorCodec::Encode<N>(source.data(), destination.data());
+        if (k > destination.size())
+            return -1;
+        if (k != VectorCodec::Encode(source.data(), source.size(), expected.data()))
+            return -3;
+        destination.resize(k);
+        expected.resize(k);
+        if (destination != expected)
+            return -3;
+        vector<float> check;
+        check.resize(N);
+        VectorCodec::Decode<N>(destination.data(), check.data());
+        if (check != source)
+            return -2;
+    }
+    return 0;
+}
+
+
+// Counts the live allocations and throws once a budget of allocations is used up.
+template <typename T>
+struct LimitedAllocator
+{
+    using value_type = T;
+
+    size_t* live;
+    size_t* budget;
+
+    LimitedAllocator(size_t* live, size_t* budget) : live(live), budget(budget) {}
+    template <typename U>
+    LimitedAllocator(const LimitedAllocator<U>& other) : live(other.live), budget(other.budget) {}
+
+    T* allocate(size_t n)
+    {
+        if (*budget == 0)
+            throw std::bad_alloc();
+        --*budget;
+        ++*live;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        --*live;
+        std::allocator<T>().deallocate(p, n);
+    }
 
+    template <typename U>
+    bool operator==(const LimitedAllocator<U>& other) const { return live == other.live; }
+    template <typename U>
+    bool operator!=(const LimitedAllocator<U>& other) const { return live != other.live; }
+};
 
 int main()
 {
@@ -55,5 +134,1072 @@ int main()
                     return -2;
         }   
     }
+    for (int n = 16; n != 4096; n *= 2)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> sources[7];
+            vector<uint8_t> destinations[7];
+            vector<float> checks[7];
+            const uint8_t* compressed[7];
+            size_t counts[7];
+            float* outs[7];
+            for (size_t j = 0; j != 7; ++j)
+            {
+                sources[j].resize(n + j * 3);
+                for (auto& e : sources[j])
+                    e = dist(engine);
+                destinations[j].resize(VectorCodec::UpperBound(sources[j].size()));
+                auto k = VectorCodec::Encode(sources[j].data(), sources[j].size(), destinations[j].data());
+                if (k > destinations[j].size())
+                    return -1;
+                checks[j].resize(sources[j].size());
+                compressed[j] = destinations[j].data();
+                counts[j] = checks[j].size();
+                outs[j] = checks[j].data();
+            }
+            VectorCodec::DecodeMany(compressed, counts, outs, 7);
+            for (size_t j = 0; j != 7; ++j)
+                if (checks[j] != sources[j])
+                    return -2;
+        }
+    }
+    if (int r = TestFixed<16>(engine))
+        return r;
+    if (int r = TestFixed<32>(engine))
+        return r;
+    if (int r = TestFixed<64>(engine))
+        return r;
+    if (int r = TestFixed<128>(engine))
+        return r;
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+                e = (i & 1) ? dist(engine) : (float)(int)dist(engine);
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundCompact(n));
+            auto k = VectorCodec::EncodeCompact(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            destination.resize(k);
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeCompact(destination.data(), check.size(), check.data());
+            if (check != source)
+                return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+                e = (i & 1) ? dist(engine) : (float)(int)(dist(engine) / 1000) * 0.25f;
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundChimp(n));
+            auto k = VectorCodec::EncodeChimp(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            destination.resize(k);
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeChimp(destination.data(), check.size(), check.data());
+            if (check != source)
+                return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+                e = (i % 3 == 0) ? dist(engine) : (float)(int)(dist(engine) * 100) / 100;
+            if (i % 3 == 1)
+                for (size_t j = 0; j < source.size(); j += 97)
+                    source[j] = dist(engine);
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundALP(n));
+            auto k = VectorCodec::EncodeALP(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            destination.resize(k);
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeALP(destination.data(), check.size(), check.data());
+            if (memcmp(check.data(), source.data(), check.size() * sizeof(float)) != 0)
+                return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> levels;
+            levels.resize(1 + i * 3);
+            for (auto& e : levels)
+                e = dist(engine);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+                e = (i % 4 == 3) ? dist(engine) : levels[engine() % levels.size()];
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundDictionary(n));
+            auto k = VectorCodec::EncodeDictionary(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            vector<float> check;
+            check.resize(source.size());
+            if (k != 0)
+            {
+                VectorCodec::DecodeDictionary(destination.data(), check.size(), check.data());
+                if (check != source)
+                    return -2;
+            }
+            else if (levels.size() <= 256 && i % 4 != 3)
+                return -4;
+            destination.resize(VectorCodec::UpperBoundAuto(n));
+            k = VectorCodec::EncodeAuto(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            if (n >= 4095 && levels.size() <= 16 && i % 4 != 3 && destination[0] != (uint8_t)VectorCodec::Format::Dictionary)
+                return -3;
+            VectorCodec::DecodeAuto(destination.data(), check.size(), check.data());
+            if (check != source)
+                return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            float level = dist(engine);
+            for (auto& e : source)
+            {
+                if (engine() % (1 + i * 10) == 0)
+                    level = dist(engine);
+                e = level;
+            }
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundRLE(n));
+            auto k = VectorCodec::EncodeRLE(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            destination.resize(k);
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeRLE(destination.data(), check.size(), check.data());
+            if (check != source)
+                return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 100; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+            {
+                switch (i % 5)
+                {
+                case 0:
+                    e = (float)(int)(dist(engine) / 100);
+                    break;
+                case 1:
+                    e = (float)(int)dist(engine);
+                    break;
+                case 2:
+                    e = (float)(int)(dist(engine) / 5) / 1024;
+                    break;
+                case 3:
+                {
+                    uint32_t bits = (uint32_t)engine() & 0xFFFF0000U;
+                    memcpy(&e, &bits, 4);
+                    break;
+                }
+                default:
+                    e = dist(engine);
+                    break;
+                }
+            }
+            if (i % 10 == 9)
+                source[engine() % source.size()] = dist(engine);
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundDowncast(n));
+            auto k = VectorCodec::EncodeDowncast(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            destination.resize(k);
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeDowncast(destination.data(), check.size(), check.data());
+            if (memcmp(check.data(), source.data(), check.size() * sizeof(float)) != 0)
+                return -2;
+        }
+    }
+#ifdef __F16C__
+    // The conversion used without F16C must match the instruction on every half, except that the instruction quiets signaling NaNs.
+    for (uint32_t i = 0; i < 65536; i += 8)
+    {
+        alignas(16) uint16_t halves[8];
+        for (uint32_t j = 0; j != 8; ++j)
+            halves[j] = (uint16_t)(i + j);
+        const __m128i half = _mm_load_si128((const __m128i*)halves);
+        uint32_t fallback[8], hardware[8];
+        _mm256_storeu_ps((float*)fallback, VectorCodec::Impl::HalfToFloatFallback_AVX2(half));
+        _mm256_storeu_ps((float*)hardware, _mm256_cvtph_ps(half));
+        for (uint32_t j = 0; j != 8; ++j)
+        {
+            const bool nan = (fallback[j] & 0x7FFFFFFF) > 0x7F800000;
+            if ((nan ? fallback[j] | 0x00400000 : fallback[j]) != hardware[j])
+                return -2;
+        }
+    }
+#endif
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 32; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+                e = dist(engine);
+            const uint32_t rate = 1 + (uint32_t)i;
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundFixedRate(n, rate));
+            auto k = VectorCodec::EncodeFixedRate(source.data(), source.size(), rate, destination.data());
+            if (k != destination.size())
+                return -1;
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeFixedRate(destination.data(), check.size(), rate, check.data());
+            for (size_t j = 0; j < check.size(); j += 16)
+            {
+                float block[16];
+                VectorCodec::DecodeBlock(destination.data(), rate, j / 16, block);
+                if (memcmp(block, check.data() + j, (check.size() - j < 16 ? check.size() - j : 16) * sizeof(float)) != 0)
+                    return -2;
+            }
+            // Each bit per value roughly halves the error relative to the largest magnitude of the block, down to float precision.
+            for (size_t j = 0; j < check.size(); j += 16)
+            {
+                const size_t end = check.size() - j < 16 ? check.size() : j + 16;
+                float magnitude = 0;
+                for (size_t l = j; l != end; ++l)
+                    magnitude = fmax(magnitude, fabs(source[l]));
+                const float bound = ldexp(magnitude, max(6 - (int)rate, -22));
+                for (size_t l = j; l != end; ++l)
+                    if (!(fabs(check[l] - source[l]) <= bound))
+                        return -2;
+            }
+            if (rate == 32)
+                for (size_t j = 0; j != check.size(); ++j)
+                    if (fabs(check[j] - source[j]) > 0.01f)
+                        return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 30; ++i)
+        {
+            uniform_real_distribution<float> dist(-10000, 10000);
+            vector<float> source;
+            source.resize(n);
+            for (auto& e : source)
+                e = dist(engine);
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundToBudget(n));
+            const size_t full = VectorCodec::Encode(source.data(), source.size(), destination.data());
+            const size_t target = full - full * (size_t)(i % 3) / 5;
+            auto k = VectorCodec::EncodeToBudget(source.data(), source.size(), target, destination.data());
+            if (k > target)
+                return -1;
+            if (k == 0)
+                continue;
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::Decode(destination.data(), check.size(), check.data());
+            for (size_t j = 0; j != check.size(); ++j)
+                if ((i % 3 == 0) ? check[j] != source[j] : fabs(check[j] - source[j]) > fabs(source[j]) * 0.5f)
+                    return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 30; ++i)
+        {
+            uniform_real_distribution<float> dist(-1, 1);
+            vector<float> source;
+            source.resize(n);
+            float walk = 0;
+            for (auto& e : source)
+                e = walk += dist(engine);
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundProgressive(n));
+            auto k = VectorCodec::EncodeProgressive(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            vector<float> check;
+            check.resize(source.size());
+            for (size_t available = k * (size_t)(i % 5) / 4; available <= k; available += k)
+            {
+                const uint32_t exact = VectorCodec::DecodeProgressive(destination.data(), check.size(), available, check.data());
+                if (available == k && exact != 4)
+                    return -2;
+                for (size_t j = 0; j != check.size() && exact != 0; ++j)
+                {
+                    uint32_t a, b;
+                    memcpy(&a, &check[j], 4);
+                    memcpy(&b, &source[j], 4);
+                    if ((a ^ b) >> (32 - exact * 8) != 0)
+                        return -2;
+                }
+            }
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 30; ++i)
+        {
+            uniform_real_distribution<float> dist(-1, 1);
+            vector<float> source;
+            source.resize(n);
+            float walk = 0;
+            for (auto& e : source)
+                e = walk += dist(engine);
+            if (i % 3 == 0)
+                for (size_t j = 0; j < source.size(); j += 1 + engine() % 16)
+                    source[j] = NAN;
+            vector<uint8_t> destination;
+            destination.resize(VectorCodec::UpperBoundPlot(n));
+            auto k = VectorCodec::EncodePlot(source.data(), source.size(), destination.data());
+            if (k > destination.size())
+                return -1;
+            uniform_int_distribution<size_t> position(0, n);
+            size_t t0 = position(engine), t1 = position(engine);
+            if (t0 > t1)
+                swap(t0, t1);
+            const size_t pixels = 1 + i * 7;
+            vector<float> check;
+            check.resize(pixels * 4);
+            VectorCodec::DecodeForPlot(destination.data(), t0, t1, pixels, check.data());
+            for (size_t p = 0; p != pixels; ++p)
+            {
+                const size_t first = t0 + (t1 - t0) * p / pixels;
+                const size_t last = t0 + (t1 - t0) * (p + 1) / pixels;
+                if (first == last)
+                {
+                    if (!isnan(check[p * 4]))
+                        return -2;
+                    continue;
+                }
+                float low = INFINITY, high = -INFINITY;
+                for (size_t j = first; j != last; ++j)
+                {
+                    low = fmin(low, source[j]);
+                    high = fmax(high, source[j]);
+                }
+                if (check[p * 4] != low || check[p * 4 + 1] != high || memcmp(&check[p * 4 + 2], &source[first], 4) != 0 || memcmp(&check[p * 4 + 3], &source[last - 1], 4) != 0)
+                    return -2;
+            }
+        }
+    }
+    {
+        vector<float> source(2048, 1.0f);
+        source[1] = -100;
+        source[9] = NAN;
+        vector<uint8_t> destination(VectorCodec::UpperBoundPlot(source.size()));
+        if (VectorCodec::EncodePlot(source.data(), source.size(), destination.data()) > destination.size())
+            return -1;
+        float check[8];
+        VectorCodec::DecodeForPlot(destination.data(), 0, source.size(), 1, check);
+        VectorCodec::DecodeForPlot(destination.data(), 1, 10, 1, check + 4);
+        if (check[0] != -100 || check[1] != 1 || check[4] != -100 || check[5] != 1)
+            return -2;
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        uniform_real_distribution<float> dist(-1, 1);
+        vector<float> source;
+        source.resize(n);
+        float walk = 0;
+        for (auto& e : source)
+            e = walk += dist(engine);
+        VectorCodec::CompressedArray<float> array(source.data(), source.size());
+        VectorCodec::CompressedArray<float> moved(std::move(array));
+        if (!array.empty() || moved.size() != source.size())
+            return -1;
+        size_t j = 0;
+        for (float e : moved)
+            if (e != source[j++])
+                return -2;
+        uniform_int_distribution<size_t> position(0, n - 1);
+        for (int i = 0; i != 100; ++i)
+        {
+            j = position(engine);
+            if (moved[j] != source[j] || moved.begin()[j] != source[j] || *(moved.end() - (n - j)) != source[j])
+                return -2;
+        }
+        vector<float> check(moved.begin(), moved.end());
+        if (!equal(check.begin(), check.end(), source.begin()))
+            return -2;
+    }
+    {
+        uniform_real_distribution<float> dist(-1, 1);
+        vector<vector<float>> sources(4);
+        vector<VectorCodec::CompressedArray<float>> arrays;
+        for (auto& source : sources)
+        {
+            source.resize(100000);
+            float walk = 0;
+            for (auto& e : source)
+                e = walk += dist(engine);
+            arrays.emplace_back(source.data(), source.size());
+        }
+        VectorCodec::BlockCache cache(64 * 1024);
+        atomic<int> failures{ 0 };
+        vector<thread> threads;
+        for (int t = 0; t != 8; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                ranlux48 local(t);
+                uniform_int_distribution<size_t> pick(0, 3);
+                float block[VectorCodec::CompressedArray<float>::block_size];
+                for (int i = 0; i != 20000; ++i)
+                {
+                    const size_t a = pick(local);
+                    const size_t b = i % 2 == 0 ? (size_t)i / 2 % 8 : uniform_int_distribution<size_t>(0, arrays[a].block_count() - 1)(local);
+                    cache.Read(arrays[a], a, b, block);
+                    if (memcmp(block, sources[a].data() + b * 256, arrays[a].block_length(b) * sizeof(float)) != 0)
+                        ++failures;
+                }
+            });
+        }
+        for (auto& e : threads)
+            e.join();
+        if (failures != 0)
+            return -2;
+        cache.Invalidate(0);
+        arrays[0] = VectorCodec::CompressedArray<float>(sources[1].data(), sources[1].size());
+        float block[VectorCodec::CompressedArray<float>::block_size];
+        cache.Read(arrays[0], 0, 3, block);
+        if (memcmp(block, sources[1].data() + 3 * 256, sizeof(block)) != 0)
+            return -2;
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        uniform_real_distribution<float> dist(-1, 1);
+        vector<float> source;
+        source.resize(n);
+        float walk = 0;
+        for (auto& e : source)
+            e = walk += dist(engine);
+        VectorCodec::MutableCompressedArray<float> array(source.data(), source.size());
+        uniform_int_distribution<size_t> position(0, n - 1);
+        for (int i = 0; i != 2000; ++i)
+        {
+            const size_t j = position(engine);
+            if (i % 3 == 0)
+            {
+                source[j] = dist(engine);
+                array.set(j, source[j]);
+            }
+            else if (array[j] != source[j])
+            {
+                return -2;
+            }
+        }
+        vector<float> check;
+        check.resize(source.size());
+        array.decode(check.data());
+        if (check != source)
+            return -2;
+        array.compact();
+        array.decode(check.data());
+        if (check != source)
+            return -2;
+    }
+    {
+        vector<float> source(5000, 1.0f);
+        size_t live = 0, budget = 10;
+        try
+        {
+            VectorCodec::MutableCompressedArray<float, LimitedAllocator<float>> array(source.data(), source.size(), LimitedAllocator<float>(&live, &budget));
+            return -2;
+        }
+        catch (const std::bad_alloc&)
+        {
+            if (live != 0)
+                return -2;
+        }
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        uniform_real_distribution<float> dist(-1, 1);
+        vector<float> source;
+        source.resize(n);
+        float walk = 0;
+        for (auto& e : source)
+            e = walk += dist(engine);
+        vector<uint8_t> destination;
+        destination.resize(VectorCodec::AppendFooterSize + n * VectorCodec::UpperBoundAppend(1));
+        auto stream = VectorCodec::OpenForAppend(destination.data(), 0);
+        uniform_int_distribution<size_t> chunk(0, 1 + n / 4);
+        for (size_t i = 0; i != source.size();)
+        {
+            const size_t k = min(chunk(engine), source.size() - i);
+            const size_t size = stream.size;
+            stream = VectorCodec::OpenForAppend(destination.data(), size);
+            if (VectorCodec::Append(stream, source.data() + i, k) > size + VectorCodec::UpperBoundAppend(k))
+                return -1;
+            i += k;
+        }
+        if (VectorCodec::OpenForAppend(destination.data(), stream.size).value_count != source.size())
+            return -1;
+        vector<float> check;
+        check.resize(source.size());
+        VectorCodec::DecodeAppendable(destination.data(), stream.size, check.data());
+        if (check != source)
+            return -2;
+    }
+    for (int n = 1; n < 65536; n = n * 2 + 1)
+    {
+        uniform_real_distribution<float> dist(-1, 1);
+        vector<float> source;
+        source.resize(n);
+        float walk = 0;
+        for (auto& e : source)
+            e = walk += dist(engine);
+        vector<VectorCodec::CompressedArray<float>> parts;
+        uniform_int_distribution<size_t> position(0, n);
+        size_t first = 0;
+        for (size_t last : { position(engine), position(engine), (size_t)n })
+        {
+            if (last < first)
+                continue;
+            parts.emplace_back(source.data() + first, last - first);
+            first = last;
+        }
+        const auto array = VectorCodec::CompressedArray<float>::concat(parts.data(), parts.size());
+        if (array.size() != source.size() || !equal(array.begin(), array.end(), source.begin()))
+            return -2;
+        for (int i = 0; i != 20; ++i)
+        {
+            size_t t0 = position(engine), t1 = position(engine);
+            if (t0 > t1)
+                swap(t0, t1);
+            const auto slice = array.slice(t0, t1 - t0);
+            vector<float> check;
+            check.resize(slice.size());
+            slice.decode(check.data());
+            if (check.size() != t1 - t0 || !equal(check.begin(), check.end(), source.begin() + t0))
+                return -2;
+            if (t1 - t0 > 2 && slice.slice(1, t1 - t0 - 2)[0] != source[t0 + 1])
+                return -2;
+        }
+    }
+    for (int n = 0; n < 65536; n = n * 2 + 1)
+    {
+        for (int i = 0; i != 64; ++i)
+        {
+            uniform_real_distribution<float> dist(-1, 1);
+            vector<float> source;
+            source.resize(n);
+            float walk = 0;
+            for (auto& e : source)
+                e = walk += dist(engine);
+            const VectorCodec::Format formats[] = { VectorCodec::Format::Default, VectorCodec::Format::Quick, VectorCodec::Format::Compact, VectorCodec::Format::Chimp, VectorCodec::Format::ALP, VectorCodec::Format::Dictionary, VectorCodec::Format::RLE, VectorCodec::Format::Downcast };
+            const auto from = formats[i % 8], to = formats[i / 8];
+            if (from == VectorCodec::Format::Dictionary || to == VectorCodec::Format::Dictionary)
+                for (auto& e : source)
+                    e = floorf(e / 8);
+            vector<uint8_t> compressed, destination;
+            compressed.resize(VectorCodec::UpperBoundAuto(n));
+            destination.resize(VectorCodec::UpperBoundTranscode(to, n));
+            const size_t k = VectorCodec::EncodeAuto(source.data(), source.size(), compressed.data());
+            const size_t direct = VectorCodec::Transcode((VectorCodec::Format)compressed[0], to, compressed.data() + 1, source.size(), destination.data());
+            if (direct == SIZE_MAX || k == 0)
+                return -1;
+            compressed.resize(VectorCodec::UpperBoundTranscode(from, n) + 1);
+            const size_t converted = VectorCodec::Transcode(to, from, destination.data(), source.size(), compressed.data() + 1);
+            compressed[0] = (uint8_t)from;
+            vector<float> check;
+            check.resize(source.size());
+            VectorCodec::DecodeAuto(compressed.data(), check.size(), check.data());
+            if (converted == SIZE_MAX || check != source)
+                return -2;
+        }
+    }
+    {
+        vector<float> source(5000);
+        for (size_t i = 0; i != source.size(); ++i)
+            source[i] = (float)i;
+        vector<uint8_t> compressed(VectorCodec::UpperBound(source.size())), destination(VectorCodec::UpperBoundTranscode(VectorCodec::Format::Dictionary, source.size()));
+        if (VectorCodec::Encode(source.data(), source.size(), compressed.data()) == 0)
+            return -1;
+        if (VectorCodec::Transcode(VectorCodec::Format::Default, VectorCodec::Format::Dictionary, compressed.data(), source.size(), destination.data()) != SIZE_MAX)
+            return -2;
+    }
+    {
+        const char* path = "VectorCodecTest.archive";
+        vector<vector<float>> sources(40);
+        VectorCodec::ArchiveWriter writer;
+        if (!writer.Open(path))
+            return -1;
+        for (size_t i = 0; i != sources.size(); ++i)
+        {
+            uniform_real_distribution<float> dist(-1, 1);
+            const uint64_t shape[2] = { i % 7, i * 13 % 300 };
+            sources[i].resize(shape[0] * shape[1]);
+            float walk = 0;
+            for (auto& e : sources[i])
+                e = walk += dist(engine);
+            const string name = "array" + to_string(i * 7919 % 40);
+            if (!writer.Add(name.c_str(), sources[i].data(), shape, 2))
+                return -1;
+        }
+        if (!writer.Close())
+            return -1;
+        auto archive = VectorCodec::Archive::Open(path);
+        if (!archive || archive.Count() != sources.size() || archive.Find("missing") != nullptr)
+            return -1;
+        for (size_t i = 0; i != sources.size(); ++i)
+        {
+            const string name = "array" + to_string(i * 7919 % 40);
+            const VectorCodec::ArchiveEntry* entry = archive.Find(name.c_str());
+            if (entry == nullptr || entry->rank != 2 || entry->shape[0] != i % 7 || entry->value_count != sources[i].size())
+                return -1;
+            vector<float> check;
+            check.resize(sources[i].size());
+            if (!archive.Read(*entry, check.data()) || check != sources[i])
+                return -2;
+        }
+        archive = VectorCodec::Archive();
+        // An index with a valid checksum must still be rejected when a value count does not match the shape, or is more than the
+        // compressed size of the entry can hold.
+        vector<uint8_t> bytes;
+        {
+            FILE* file = fopen(path, "rb");
+            if (file == nullptr || fseek(file, 0, SEEK_END) != 0)
+                return -1;
+            bytes.resize((size_t)ftell(file));
+            rewind(file);
+            const bool read = fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+            fclose(file);
+            if (!read)
+                return -1;
+        }
+        for (int variant = 0; variant != 2; ++variant)
+        {
+            vector<uint8_t> corrupt = bytes;
+            uint64_t index_offset, index_size;
+            memcpy(&index_offset, corrupt.data() + corrupt.size() - 32, 8);
+            memcpy(&index_size, corrupt.data() + corrupt.size() - 24, 8);
+            uint8_t* record = corrupt.data() + index_offset;
+            for (;;)
+            {
+                uint32_t name_length;
+                memcpy(&name_length, record, 4);
+                uint8_t* const fields = record + 4 + name_length + 1;
+                uint64_t value_count, shape[2];
+                memcpy(&value_count, fields + 24, 8);
+                memcpy(shape, fields + 32, 16);
+                record = fields + 48;
+                if (value_count < 64 || fields[1] == (uint8_t)VectorCodec::Format::Dictionary || fields[1] == (uint8_t)VectorCodec::Format::RLE)
+                    continue;
+                value_count *= 1000;
+                if (variant == 1)
+                    shape[1] *= 1000;
+                memcpy(fields + 24, &value_count, 8);
+                memcpy(fields + 32, shape, 16);
+                break;
+            }
+            const uint32_t checksum = VectorCodec::Impl::Checksum(corrupt.data() + index_offset, (size_t)index_size);
+            memcpy(corrupt.data() + corrupt.size() - 8, &checksum, 4);
+            FILE* file = fopen(path, "wb");
+            const bool written = file != nullptr && fwrite(corrupt.data(), 1, corrupt.size(), file) == corrupt.size();
+            if (file != nullptr)
+                fclose(file);
+            if (!written)
+                return -1;
+            if (VectorCodec::Archive::Open(path))
+                return -2;
+        }
+        remove(path);
+        if (VectorCodec::Archive::Open(path))
+            return -1;
+    }
+    {
+        const char* path = "VectorCodecTest.table";
+        const char* names[] = { "index", "walk", "sparse", "constant" };
+        const size_t row_count = 100003, rows_per_group = 4096;
+        vector<vector<float>> columns(4, vector<float>(row_count));
+        uniform_real_distribution<float> dist(-1, 1);
+        float walk = 0;
+        for (size_t i = 0; i != row_count; ++i)
+        {
+            columns[0][i] = (float)i;
+            columns[1][i] = walk += dist(engine);
+            columns[2][i] = i % 3 == 0 ? dist(engine) : NAN;
+            columns[3][i] = 42;
+        }
+        for (int variant = 0; variant != 2; ++variant)
+        {
+            const VectorCodec::Format formats[] = { VectorCodec::Format::Default, VectorCodec::Format::Quick, VectorCodec::Format::Dictionary, VectorCodec::Format::RLE };
+            VectorCodec::TableWriter writer;
+            if (!writer.Open(path, names, 4, rows_per_group, variant == 0 ? nullptr : formats))
+                return -1;
+            for (size_t done = 0; done != row_count;)
+            {
+                const size_t n = min<size_t>(row_count - done, 1 + done % 7000);
+                const float* pointers[4] = { columns[0].data() + done, columns[1].data() + done, columns[2].data() + done, columns[3].data() + done };
+                if (!writer.Append(pointers, n))
+                    return -1;
+                done += n;
+            }
+            if (!writer.Close())
+                return -1;
+            const auto table = VectorCodec::Table::Open(path);
+            if (!table || table.RowCount() != row_count || table.RowGroupCount() != (row_count + rows_per_group - 1) / rows_per_group || table.FindColumn("walk") != 1 || table.FindColumn("missing") != 4)
+                return -1;
+            const VectorCodec::ColumnChunk& first = table.Chunk(0, 0);
+            if (first.min != 0 || first.max != rows_per_group - 1 || first.nan_count != 0 || table.Chunk(0, 2).nan_count != rows_per_group - (rows_per_group + 2) / 3)
+                return -1;
+            const uint32_t projection[] = { 2, 0 };
+            const VectorCodec::RangeFilter filter = { 0, 50000, 60000 };
+            vector<uint8_t> seen(table.RowGroupCount());
+            atomic<bool> equal_values = { true };
+            const bool scanned = table.Scan(projection, 2, &filter, 1, 4, [&](uint64_t group, uint64_t first_row, size_t n, const float* const* values)
+            {
+                seen[group] = 1;
+                if (first_row != group * rows_per_group || n != table.GroupRowCount(group) ||
+                    memcmp(values[0], columns[2].data() + first_row, n * 4) != 0 || memcmp(values[1], columns[0].data() + first_row, n * 4) != 0)
+                    equal_values = false;
+            });
+            if (!scanned || !equal_values)
+                return -2;
+            for (size_t group = 0; group != seen.size(); ++group)
+                if (seen[group] != (group * rows_per_group <= 60000 && (group + 1) * rows_per_group > 50000))
+                    return -2;
+            for (unsigned thread_count : { 1, 4 })
+            {
+                try
+                {
+                    (void)table.Scan(projection, 2, nullptr, 0, thread_count, [&](uint64_t group, uint64_t, size_t, const float* const*)
+                    {
+                        if (group % 2 == 1)
+                            throw (int)group;
+                    });
+                    return -2;
+                }
+                catch (int group)
+                {
+                    if (group % 2 != 1)
+                        return -2;
+                }
+            }
+        }
+        // Rewrites the group size and the row count of the table at path, keeping its metadata checksum valid.
+        const auto patch_header = [&](uint64_t new_rows_per_group, uint64_t new_row_count)
+        {
+            vector<uint8_t> bytes;
+            FILE* file = fopen(path, "rb");
+            if (file == nullptr || fseek(file, 0, SEEK_END) != 0)
+                return false;
+            bytes.resize((size_t)ftell(file));
+            rewind(file);
+            const bool read = fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+            fclose(file);
+            if (!read)
+                return false;
+            uint64_t metadata_offset, metadata_size;
+            memcpy(&metadata_offset, bytes.data() + bytes.size() - 24, 8);
+            memcpy(&metadata_size, bytes.data() + bytes.size() - 16, 8);
+            memcpy(bytes.data() + metadata_offset + 8, &new_rows_per_group, 8);
+            memcpy(bytes.data() + metadata_offset + 16, &new_row_count, 8);
+            const uint32_t checksum = VectorCodec::Impl::Checksum(bytes.data() + metadata_offset, (size_t)metadata_size);
+            memcpy(bytes.data() + bytes.size() - 8, &checksum, 4);
+            file = fopen(path, "wb");
+            const bool written = file != nullptr && fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+            if (file != nullptr)
+                fclose(file);
+            return written;
+        };
+        // Scaling both by the same factor keeps the number of chunks, which are then too small for their rows.
+        if (!patch_header(rows_per_group * 1000, row_count * 1000) || VectorCodec::Table::Open(path))
+            return -2;
+        // A group size above the row count only costs the rows that exist.
+        {
+            VectorCodec::TableWriter writer;
+            const float* pointers[4] = { columns[0].data(), columns[1].data(), columns[2].data(), columns[3].data() };
+            if (!writer.Open(path, names, 4, 16) || !writer.Append(pointers, 10) || !writer.Close() || !patch_header((uint64_t)1 << 60, 10))
+                return -1;
+            const auto table = VectorCodec::Table::Open(path);
+            const uint32_t projection[] = { 0 };
+            size_t scanned_rows = 0;
+            if (!table || table.RowGroupCount() != 1 || !table.Scan(projection, 1, nullptr, 0, 1, [&](uint64_t, uint64_t, size_t n, const float* const* values)
+            {
+                scanned_rows += n;
+                if (memcmp(values[0], columns[0].data(), n * 4) != 0)
+                    scanned_rows = 0;
+            }) || scanned_rows != 10)
+                return -2;
+        }
+        remove(path);
+    }
+    {
+        const char* path = "VectorCodecTest.log";
+        const auto remove_files = [&]
+        {
+            remove((string(path) + ".manifest").c_str());
+            for (int i = 0; i != 1000; ++i)
+            {
+                remove((string(path) + "." + to_string(i) + ".log").c_str());
+                remove((string(path) + "." + to_string(i) + ".dat").c_str());
+            }
+        };
+        remove_files();
+        vector<float> source(300000);
+        uniform_real_distribution<float> dist(-1, 1);
+        float walk = 0;
+        for (auto& e : source)
+            e = walk += dist(engine);
+        const auto check_range = [&](const VectorCodec::SegmentedLog::Snapshot& snapshot, uint64_t first, size_t count)
+        {
+            vector<float> check(count);
+            return snapshot.Read(first, count, check.data()) && equal(check.begin(), check.end(), source.begin() + first);
+        };
+        const auto check_all = [&](const VectorCodec::SegmentedLog::Snapshot& snapshot)
+        {
+            return check_range(snapshot, 0, (size_t)snapshot.ValueCount());
+        };
+        size_t appended = 0;
+        {
+            VectorCodec::SegmentedLog log;
+            if (!log.Open(path, 4096, 50000, 4))
+                return -1;
+            atomic<bool> done = { false }, reads_equal = { true };
+            thread reader([&]
+            {
+                mt19937 reader_engine;
+                while (!done)
+                {
+                    const auto snapshot = log.TakeSnapshot();
+                    const uint64_t n = snapshot.ValueCount();
+                    const uint64_t first = n != 0 ? reader_engine() % n : 0;
+                    if (!check_range(snapshot, first, (size_t)min<uint64_t>(n - first, reader_engine() % 5000)))
+                        reads_equal = false;
+                }
+            });
+            VectorCodec::SegmentedLog::Snapshot early;
+            while (appended != 200000)
+            {
+                const size_t n = min<size_t>(200000 - appended, 1 + engine() % 500);
+                if (!log.Append(source.data() + appended, n))
+                    return -1;
+                appended += n;
+                if (appended > 20000 && early.ValueCount() == 0)
+                    early = log.TakeSnapshot();
+            }
+            done = true;
+            reader.join();
+            if (!reads_equal || log.ValueCount() != appended || !log.Compact() || log.SegmentCount() > 6 || !check_all(early) || !check_all(log.TakeSnapshot()))
+                return -2;
+            if (!log.Close())
+                return -1;
+        }
+        {
+            VectorCodec::SegmentedLog log;
+            if (!log.Open(path, 4096, 50000, 4) || log.ValueCount() != appended || !check_all(log.TakeSnapshot()))
+                return -2;
+            for (size_t n; appended != source.size(); appended += n)
+            {
+                n = min<size_t>(source.size() - appended, 1 + engine() % 500);
+                if (!log.Append(source.data() + appended, n))
+                    return -1;
+            }
+            if (!log.WaitForCompaction() || log.SegmentCount() > 12 || !check_all(log.TakeSnapshot()) || log.TakeSnapshot().ValueCount() != source.size())
+                return -2;
+        }
+        remove_files();
+        {
+            VectorCodec::SegmentedLog log;
+            if (!log.Open(path, 1 << 20, 50000, 4) || !log.Append(source.data(), 100) || !log.Append(source.data() + 100, 200) || !log.Close())
+                return -1;
+        }
+        {
+            // A corrupted value count in the second record header must end the segment after the first record.
+            FILE* file = nullptr;
+            for (int i = 0; i != 1000 && file == nullptr; ++i)
+                file = fopen((string(path) + "." + to_string(i) + ".log").c_str(), "r+b");
+            uint32_t header[3];
+            const uint32_t count = 100;
+            const bool written = file != nullptr && fread(header, 4, 3, file) == 3 && fseek(file, (long)(12 + header[1]), SEEK_SET) == 0 && fwrite(&count, 4, 1, file) == 1;
+            if (file != nullptr)
+                fclose(file);
+            VectorCodec::SegmentedLog log;
+            if (!written || !log.Open(path, 1 << 20, 50000, 4))
+                return -1;
+            if (log.ValueCount() != 100 || !check_all(log.TakeSnapshot()))
+                return -2;
+        }
+        remove_files();
+    }
+#ifdef __linux__
+    {
+        uniform_real_distribution<float> dist(-1, 1);
+        vector<float> source(1000003);
+        float walk = 0;
+        for (auto& e : source)
+            e = walk += dist(engine);
+        vector<VectorCodec::CompressedArray<float>> parts;
+        parts.emplace_back(source.data(), 123457);
+        parts.emplace_back(source.data() + 123457, source.size() - 123457);
+        const auto array = VectorCodec::CompressedArray<float>::concat(parts.data(), parts.size());
+        for (size_t resident_bytes : { (size_t)0, 4 * VectorCodec::DecompressedMapping::fault_size })
+        {
+            const auto mapping = VectorCodec::MapDecompressed(array, resident_bytes);
+            if (!mapping)
+            {
+                printf("Skipping the DecompressedMapping test: userfaultfd is not available.\n");
+                break;
+            }
+            // A system call reading an untouched page must fault it in, unless only user mode faults can be served.
+            const int probe = (int)syscall(SYS_userfaultfd, O_CLOEXEC);
+            if (probe >= 0)
+                close(probe);
+            int pipe_fds[2];
+            if (pipe(pipe_fds) != 0)
+                return -1;
+            const size_t first = 3 * VectorCodec::DecompressedMapping::fault_size / 4;
+            vector<float> piped(1024);
+            const ssize_t written = write(pipe_fds[1], mapping.data() + first, piped.size() * 4);
+            const int write_error = errno;
+            const bool piped_equal = written == (ssize_t)piped.size() * 4 && read(pipe_fds[0], piped.data(), piped.size() * 4) == written &&
+                memcmp(piped.data(), source.data() + first, piped.size() * 4) == 0;
+            close(pipe_fds[0]);
+            close(pipe_fds[1]);
+            if (probe >= 0 ? !piped_equal : written != -1 || write_error != EFAULT)
+                return -2;
+            if (mapping.size() != source.size() || memcmp(mapping.data(), source.data(), source.size() * 4) != 0)
+                return -2;
+            atomic<bool> reads_equal = { true };
+            vector<thread> readers;
+            for (unsigned i = 0; i != 4; ++i)
+            {
+                readers.emplace_back([&, i]
+                {
+                    mt19937 reader_engine(i);
+                    for (int j = 0; j != 2000; ++j)
+                    {
+                        const size_t index = reader_engine() % source.size();
+                        if (memcmp(&mapping.data()[index], &source[index], 4) != 0)
+                            reads_equal = false;
+                    }
+                });
+            }
+            for (auto& reader : readers)
+                reader.join();
+            if (!reads_equal)
+                return -2;
+        }
+    }
+#endif
+    {
+        const char* name = "/VectorCodecTest.ring";
+        const size_t max_values = 1024;
+        const uint64_t frame_count = 20000;
+        const auto make_frame = [](uint64_t sequence, vector<float>& frame)
+        {
+            mt19937 frame_engine((uint32_t)sequence);
+            uniform_real_distribution<float> dist(-1, 1);
+            frame.resize(1 + sequence * 7919 % max_values);
+            float walk = (float)sequence;
+            for (auto& e : frame)
+                e = walk += dist(frame_engine);
+        };
+        auto producer = VectorCodec::FrameRing::Create(name, 16, max_values);
+        if (!producer || VectorCodec::FrameRing::Attach("/VectorCodecTest.missing"))
+            return -1;
+        atomic<bool> frames_equal = { true };
+        atomic<uint64_t> ready_count = { 0 };
+        vector<thread> consumers;
+        for (int i = 0; i != 3; ++i)
+        {
+            consumers.emplace_back([&, i]
+            {
+                const auto ring = VectorCodec::FrameRing::Attach(name);
+                if (!ring || ring.MaxValues() != max_values)
+                {
+                    frames_equal = false;
+                    return;
+                }
+                vector<float> out(ring.MaxValues()), frame;
+                for (uint64_t sequence = 0; sequence != frame_count;)
+                {
+                    VectorCodec::FrameInfo info;
+                    VectorCodec::FrameStatus status;
+                    if (i == 0)
+                    {
+                        status = ring.Visit(sequence, [&](const VectorCodec::FrameInfo& visited, const uint8_t* compressed)
+                        {
+                            info = visited;
+                            VectorCodec::DecodeQuick(compressed, visited.value_count, out.data());
+                        });
+                    }
+                    else
+                    {
+                        status = ring.Read(sequence, out.data(), info);
+                    }
+                    if (status == VectorCodec::FrameStatus::NotPublished)
+                    {
+                        this_thread::yield();
+                        continue;
+                    }
+                    if (status == VectorCodec::FrameStatus::Overwritten)
+                    {
+                        sequence = ring.Oldest();
+                        continue;
+                    }
+                    make_frame(sequence, frame);
+                    if (info.sequence != sequence || info.timestamp != sequence * 10 || info.value_count != frame.size() || !equal(frame.begin(), frame.end(), out.begin()))
+                        frames_equal = false;
+                    ++ready_count;
+                    ++sequence;
+                }
+            });
+        }
+        vector<float> frame;
+        for (uint64_t sequence = 0; sequence != frame_count; ++sequence)
+        {
+            make_frame(sequence, frame);
+            producer.Publish(frame.data(), frame.size(), sequence * 10);
+        }
+        for (auto& consumer : consumers)
+            consumer.join();
+        if (!frames_equal || ready_count == 0 || producer.Head() != frame_count || producer.Oldest() != frame_count - 16)
+            return -2;
+        if (!VectorCodec::FrameRing::Remove(name))
+            return -1;
+    }
     return 0;
 }
\ No newline at end of file
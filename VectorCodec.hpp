@@ -22,8 +22,20 @@
 
 #ifndef VECTOR_CODEC_INCLUDED
 #define VECTOR_CODEC_INCLUDED
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #ifndef VECTOR_CODEC_RESTRICT
 #if defined(__clang__) || defined(__GNUC__)
@@ -84,335 +96,6930 @@ namespace VectorCodec
 	* @note The regular and Quick versions of VectorCodec are not compatible with each other: If you compressed the data using EncodeQuick, you must use DecodeQuick to get it back.
 	*/
 	void VECTOR_CODEC_CALL DecodeQuick(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
-}
-#endif
 
+	/** @brief Decompresses several independent arrays of floats at once.
+	* @param compressed An array of stream_count pointers to data compressed with Encode.
+	* @param value_counts An array of stream_count element counts, one per stream.
+	* @param out An array of stream_count pointers to the arrays where the decompressed values will be stored.
+	* @param stream_count The number of streams to decompress.
+	* @note Up to four streams are decoded in lockstep on the calling thread, which hides most of the latency of the lookup table. The result is identical to calling Decode once per stream.
+	*/
+	void VECTOR_CODEC_CALL DecodeMany(const uint8_t* const* compressed, const size_t* value_counts, float* const* out, size_t stream_count) noexcept;
 
+	/** @brief Compresses an array of N floats, where N is known at compile time.
+	* @param values A pointer to the array.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBound(N).
+	* @return The number of bytes stored in out.
+	* @note The output is identical to Encode(values, N, out). Small sizes are fully unrolled.
+	* @note Only N = 16, 32, 64 and 128 are instantiated by VECTOR_CODEC_IMPLEMENTATION. Other sizes require VECTOR_CODEC_INLINE in the calling translation unit.
+	*/
+	template <size_t N>
+	[[nodiscard]] size_t VECTOR_CODEC_CALL Encode(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
 
-#if defined(VECTOR_CODEC_IMPLEMENTATION) || defined(VECTOR_CODEC_INLINE)
-#if defined(_DEBUG) || !defined(NDEBUG)
-#include <cassert>
-#define VECTOR_CODEC_INVARIANT assert
-#define VECTOR_CODEC_INLINE_ALWAYS
-#endif
-#if defined(__clang__) || defined(__GNUC__)
-#include <immintrin.h>
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (uint32_t)__builtin_bswap32((VALUE))
-#else
-#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (VALUE)
-#endif
-#ifndef VECTOR_CODEC_INLINE_ALWAYS
-#define VECTOR_CODEC_INLINE_ALWAYS __attribute__((flatten))
-#endif
-#define VECTOR_CODEC_UNLIKELY_IF(CONDITION) if (__builtin_expect((CONDITION), 0))
-#ifndef VECTOR_CODEC_INVARIANT
-#define VECTOR_CODEC_INVARIANT __builtin_assume
-#endif
-#define VECTOR_CODEC_CLZ __builtin_clz
-#define VECTOR_CODEC_UNREACHABLE __builtin_unreachable()
-#else
-#include <intrin.h>
-#include <Windows.h>
-#if REG_DWORD == REG_DWORD_BIG_ENDIAN
-#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (uint32_t)_byteswap_ulong((VALUE))
-#else
-#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (VALUE)
-#endif
-#ifndef VECTOR_CODEC_INLINE_ALWAYS
-#define VECTOR_CODEC_INLINE_ALWAYS __forceinline
-#endif
-#define VECTOR_CODEC_UNLIKELY_IF(CONDITION) if ((CONDITION))
-#ifndef VECTOR_CODEC_INVARIANT
-#define VECTOR_CODEC_INVARIANT __assume
-#endif
-#define VECTOR_CODEC_CLZ __lzcnt
-#define VECTOR_CODEC_UNREACHABLE __assume(0)
-#endif
-#ifdef __clang__
-#if __has_builtin(__builtin_memcpy)
-#define VECTOR_CODEC_MEMCPY (void)__builtin_memcpy
-#else
-#include <cstring>
-#define VECTOR_CODEC_MEMCPY (void)memcpy
-#endif
-#else
-#include <cstring>
-#define VECTOR_CODEC_MEMCPY (void)memcpy
-#endif
+	/** @brief Decompresses an array of N floats, where N is known at compile time.
+	* @param compressed A pointer to the compressed data.
+	* @param out A pointer to an array of N floats where the decompressed values will be stored.
+	* @note Accepts the output of both Encode<N> and Encode(values, N, out).
+	* @note Only N = 16, 32, 64 and 128 are instantiated by VECTOR_CODEC_IMPLEMENTATION. Other sizes require VECTOR_CODEC_INLINE in the calling translation unit.
+	*/
+	template <size_t N>
+	void VECTOR_CODEC_CALL Decode(const uint8_t* VECTOR_CODEC_RESTRICT compressed, float* VECTOR_CODEC_RESTRICT out) noexcept;
 
-namespace VectorCodec
-{
-	namespace Impl
+	/** @brief Returns the size of an array compressed with EncodeCompact in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundCompact(size_t value_count) noexcept
 	{
-		constexpr uint32_t LookupSize = 128;
+		value_count = (value_count + 7) / 8;
+		return value_count * 36 + (value_count + 7) / 8;
+	}
 
-		VECTOR_CODEC_INLINE_ALWAYS static
-		__m256i VectorHash_AVX2(__m256i v, __m256i i) noexcept
-		{
-			v = _mm256_srli_epi32(v, 24);
-			v = _mm256_and_si256(v, _mm256_set1_epi32(LookupSize - 1));
-			return v;
-		}
+	/** @brief Compresses an array of floats, storing the trailing-zero half of a block header only for the blocks that use it.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundCompact(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Uses the same predictor as Encode, but the output is only compatible with DecodeCompact. It saves up to 2 bits per value on data whose residuals rarely end in a zero byte, such as noisy mantissas.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeCompact(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
 
-		VECTOR_CODEC_INLINE_ALWAYS static
-		size_t Encode_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
-		{
-			alignas(64) int32_t lookup[LookupSize] = {};
-			const float* const end = values + value_count;
-			const uint8_t* const out_begin = out;
-			__m256i indices, predicted;
-			uint32_t* out_headers = (uint32_t*)out;
-			indices = predicted = _mm256_setzero_si256();
-			out += ((value_count + 7) & ~7) / 2;
-			do
-			{
-				__m256i vec = _mm256_setzero_si256();
-				size_t n = (end - values);
-				VECTOR_CODEC_UNLIKELY_IF(n < 8)
-					VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
-				else
-					vec = _mm256_loadu_si256((const __m256i*)values);
-				lookup[_mm256_extract_epi32(indices, 0)] = _mm256_extract_epi32(vec, 0);
-				lookup[_mm256_extract_epi32(indices, 1)] = _mm256_extract_epi32(vec, 1);
-				lookup[_mm256_extract_epi32(indices, 2)] = _mm256_extract_epi32(vec, 2);
-				lookup[_mm256_extract_epi32(indices, 3)] = _mm256_extract_epi32(vec, 3);
-				lookup[_mm256_extract_epi32(indices, 4)] = _mm256_extract_epi32(vec, 4);
-				lookup[_mm256_extract_epi32(indices, 5)] = _mm256_extract_epi32(vec, 5);
-				lookup[_mm256_extract_epi32(indices, 6)] = _mm256_extract_epi32(vec, 6);
-				lookup[_mm256_extract_epi32(indices, 7)] = _mm256_extract_epi32(vec, 7);
-				indices = VectorHash_AVX2(vec, indices);
-				vec = _mm256_xor_si256(vec, predicted);
-				predicted = _mm256_i32gather_epi32(lookup, indices, 4);
-				__m256i tmp = _mm256_andnot_si256(_mm256_sub_epi32(vec, _mm256_set1_epi32(1)), vec);
-				__m256i tzcounts = _mm256_set1_epi32(32);
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(tmp, _mm256_setzero_si256()), _mm256_set1_epi32(1)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x0000ffff)), _mm256_setzero_si256()), _mm256_set1_epi32(16)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x00ff00ff)), _mm256_setzero_si256()), _mm256_set1_epi32(8)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x0f0f0f0f)), _mm256_setzero_si256()), _mm256_set1_epi32(4)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x33333333)), _mm256_setzero_si256()), _mm256_set1_epi32(2)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x55555555)), _mm256_setzero_si256()), _mm256_set1_epi32(1)));
-				tzcounts = _mm256_srli_epi32(tzcounts, 3);
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_srli_epi32(tzcounts, 2));
-				vec = _mm256_srlv_epi32(vec, _mm256_slli_epi32(tzcounts, 3));
-				__m256i lzcounts = _mm256_srli_epi32(_mm256_set_epi32(
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 7)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 6)),
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 5)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 4)),
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 3)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 2)),
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 1)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 0))), 3);
-				tmp = _mm256_sub_epi32(_mm256_set1_epi32(4), _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpeq_epi32(lzcounts, _mm256_set1_epi32(3)))));
-				lzcounts = _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpgt_epi32(lzcounts, _mm256_set1_epi32(2))));
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 0)); out += _mm256_extract_epi32(tmp, 0);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 1)); out += _mm256_extract_epi32(tmp, 1);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 2)); out += _mm256_extract_epi32(tmp, 2);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 3)); out += _mm256_extract_epi32(tmp, 3);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 4)); out += _mm256_extract_epi32(tmp, 4);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 5)); out += _mm256_extract_epi32(tmp, 5);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 6)); out += _mm256_extract_epi32(tmp, 6);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 7)); out += _mm256_extract_epi32(tmp, 7);
-#ifdef VECTOR_CODEC_EARLY_EXIT
-				VECTOR_CODEC_UNLIKELY_IF(out - out_begin > value_count * 4)
-					return 0;
-#endif
-				lzcounts = _mm256_sllv_epi32(lzcounts, _mm256_set_epi32(14, 12, 10, 8, 6, 4, 2, 0));
-				tzcounts = _mm256_sllv_epi32(tzcounts, _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16));
-				lzcounts = _mm256_or_si256(lzcounts, tzcounts);
-				lzcounts = _mm256_or_si256(lzcounts, _mm256_srli_si256(lzcounts, 8));
-				lzcounts = _mm256_or_si256(lzcounts, _mm256_srli_epi64(lzcounts, 32));
-				*out_headers = VECTOR_CODEC_BSWAP_IF_BE((uint32_t)_mm256_extract_epi32(lzcounts, 0) | (uint32_t)_mm256_extract_epi32(lzcounts, 4));
-				++out_headers;
-				values += 8;
-			} while (values < end);
-			_mm256_zeroall();
-			VECTOR_CODEC_INVARIANT(out >= out_begin);
-			return out - out_begin;
-		}
+	/** @brief Decompresses an array of floats compressed with EncodeCompact.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeCompact(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
 
-		VECTOR_CODEC_INLINE_ALWAYS
-		static void Decode_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
-		{
-			alignas(32) int32_t lookup[LookupSize] = {};
-			const uint32_t* in_headers = (const uint32_t*)data;
-			__m256i indices, predicted;
-			indices = predicted = _mm256_setzero_si256();
-			data += ((value_count + 7) & ~7) / 2;
-			while (true)
-			{
-				uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*in_headers);
-				++in_headers;
-				__m256i tmp = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(14, 10, 6, 2, 12, 8, 4, 0)), _mm256_set1_epi32(3));
-				__m128i lzcounts = _mm_or_si128(_mm256_extracti128_si256(tmp, 0), _mm256_extracti128_si256(_mm256_slli_epi32(tmp, 16), 1));
-				__m128i prefix_sum = lzcounts = _mm_sub_epi16(_mm_set1_epi16(4), _mm_add_epi16(lzcounts, _mm_srli_epi16(_mm_add_epi16(lzcounts, _mm_set1_epi16(1)), 2)));
-				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 2), prefix_sum);
-				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 4), prefix_sum);
-				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 8), prefix_sum);
-				__m256i vec = _mm256_i32gather_epi32((const int*)data, _mm256_cvtepi16_epi32(_mm_slli_si128(prefix_sum, 2)), 1);
-				data += _mm_extract_epi16(prefix_sum, 7);
-				vec = _mm256_and_si256(vec, _mm256_sub_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_slli_epi32(_mm256_cvtepi16_epi32(lzcounts), 3)), _mm256_set1_epi32(1)));
-				tmp = _mm256_slli_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16)), _mm256_set1_epi32(3)), 3);
-				vec = _mm256_xor_si256(_mm256_sllv_epi32(vec, tmp), predicted);
-				lookup[_mm256_extract_epi32(indices, 0)] = _mm256_extract_epi32(vec, 0);
-				lookup[_mm256_extract_epi32(indices, 1)] = _mm256_extract_epi32(vec, 1);
-				lookup[_mm256_extract_epi32(indices, 2)] = _mm256_extract_epi32(vec, 2);
-				lookup[_mm256_extract_epi32(indices, 3)] = _mm256_extract_epi32(vec, 3);
-				lookup[_mm256_extract_epi32(indices, 4)] = _mm256_extract_epi32(vec, 4);
-				lookup[_mm256_extract_epi32(indices, 5)] = _mm256_extract_epi32(vec, 5);
-				lookup[_mm256_extract_epi32(indices, 6)] = _mm256_extract_epi32(vec, 6);
-				lookup[_mm256_extract_epi32(indices, 7)] = _mm256_extract_epi32(vec, 7);
-				indices = VectorHash_AVX2(vec, indices);
-				predicted = _mm256_i32gather_epi32(lookup, indices, 4);
-				VECTOR_CODEC_UNLIKELY_IF(value_count < 8)
-				{
-					VECTOR_CODEC_UNLIKELY_IF(value_count != 0)
-						VECTOR_CODEC_MEMCPY(out, &vec, value_count << 2);
-					_mm256_zeroall();
-					return;
-				}
-				_mm256_storeu_si256((__m256i*)out, vec);
-				value_count -= 8;
-				out += 8;
-			}
-		}
+	/** @brief Returns the size of an array compressed with EncodeChimp in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundChimp(size_t value_count) noexcept
+	{
+		return ((value_count + 7) / 8) * 44;
+	}
 
-		VECTOR_CODEC_INLINE_ALWAYS
-		static size_t EncodeQuick_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
-		{
-			const float* const end = values + value_count;
-			const uint8_t* const out_begin = out;
-			__m256i prior;
-			uint32_t* out_headers = (uint32_t*)out;
-			prior = _mm256_setzero_si256();
-			out += ((value_count + 7) & ~7) / 2;
-			do
-			{
-				__m256i vec = _mm256_setzero_si256();
-				size_t n = (end - values);
-				VECTOR_CODEC_UNLIKELY_IF(n < 8)
-					VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
-				else
-					vec = _mm256_loadu_si256((const __m256i*)values);
-				__m256i tmp = vec;
-				vec = _mm256_sub_epi32(vec, prior);
-				prior = tmp;
-				tmp = _mm256_andnot_si256(_mm256_sub_epi32(vec, _mm256_set1_epi32(1)), vec);
-				__m256i tzcounts = _mm256_set1_epi32(32);
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(tmp, _mm256_setzero_si256()), _mm256_set1_epi32(1)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x0000ffff)), _mm256_setzero_si256()), _mm256_set1_epi32(16)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x00ff00ff)), _mm256_setzero_si256()), _mm256_set1_epi32(8)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x0f0f0f0f)), _mm256_setzero_si256()), _mm256_set1_epi32(4)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x33333333)), _mm256_setzero_si256()), _mm256_set1_epi32(2)));
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x55555555)), _mm256_setzero_si256()), _mm256_set1_epi32(1)));
-				tzcounts = _mm256_srli_epi32(tzcounts, 3);
-				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_srli_epi32(tzcounts, 2));
-				vec = _mm256_srlv_epi32(vec, _mm256_slli_epi32(tzcounts, 3));
-				__m256i lzcounts = _mm256_srli_epi32(_mm256_set_epi32(
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 7)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 6)),
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 5)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 4)),
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 3)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 2)),
-					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 1)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 0))), 3);
-				tmp = _mm256_sub_epi32(_mm256_set1_epi32(4), _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpeq_epi32(lzcounts, _mm256_set1_epi32(3)))));
-				lzcounts = _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpgt_epi32(lzcounts, _mm256_set1_epi32(2))));
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 0)); out += _mm256_extract_epi32(tmp, 0);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 1)); out += _mm256_extract_epi32(tmp, 1);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 2)); out += _mm256_extract_epi32(tmp, 2);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 3)); out += _mm256_extract_epi32(tmp, 3);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 4)); out += _mm256_extract_epi32(tmp, 4);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 5)); out += _mm256_extract_epi32(tmp, 5);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 6)); out += _mm256_extract_epi32(tmp, 6);
-				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 7)); out += _mm256_extract_epi32(tmp, 7);
-#ifdef VECTOR_CODEC_EARLY_EXIT
-				VECTOR_CODEC_UNLIKELY_IF(out - out_begin > value_count * 4)
-					return 0;
-#endif
-				lzcounts = _mm256_sllv_epi32(lzcounts, _mm256_set_epi32(14, 12, 10, 8, 6, 4, 2, 0));
-				tzcounts = _mm256_sllv_epi32(tzcounts, _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16));
-				lzcounts = _mm256_or_si256(lzcounts, tzcounts);
-				lzcounts = _mm256_or_si256(lzcounts, _mm256_srli_si256(lzcounts, 8));
-				lzcounts = _mm256_or_si256(lzcounts, _mm256_srli_epi64(lzcounts, 32));
-				*out_headers = VECTOR_CODEC_BSWAP_IF_BE((uint32_t)_mm256_extract_epi32(lzcounts, 0) | (uint32_t)_mm256_extract_epi32(lzcounts, 4));
-				++out_headers;
-				values += 8;
-			} while (values < end);
-			_mm256_zeroall();
-			VECTOR_CODEC_INVARIANT(out >= out_begin);
-			return out - out_begin;
-		}
+	/** @brief Compresses an array of floats using a Chimp128-style predictor.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundChimp(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Each value is XORed with the preceding value, or with the most recent of the 128 values before its block that shares its low 13 bits when that leaves more zero bytes. Such window references cost an extra 7 bits. This pays off on time series that revisit earlier values. Use DecodeChimp to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeChimp(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
 
-		VECTOR_CODEC_INLINE_ALWAYS
-		static void DecodeQuick_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
-		{
-			const uint32_t* in_headers = (const uint32_t*)data;
+	/** @brief Decompresses an array of floats compressed with EncodeChimp.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeChimp(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodeALP in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundALP(size_t value_count) noexcept
+	{
+		return ((value_count + 1023) / 1024) * 8 + value_count * 4 + 16;
+	}
+
+	/** @brief Compresses an array of floats that originated as decimal numbers, using ALP (Adaptive Lossless floating-Point).
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundALP(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note For each block of 1024 values, picks an exponent e and a factor f such that most values v survive the round trip round(v * 10^e / 10^f) * 10^f / 10^e bit for bit.
+	* The resulting integers are stored with frame-of-reference bit-packing, and the values that do not round-trip are stored verbatim as exceptions.
+	* Blocks where this does not pay off are stored uncompressed. This suits prices and sensor readings printed with few decimals. Use DecodeALP to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeALP(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses an array of floats compressed with EncodeALP.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeALP(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodeDictionary in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundDictionary(size_t value_count) noexcept
+	{
+		return 4 + 256 * 4 + (value_count + 7) / 8 * 8 + 8;
+	}
+
+	/** @brief Compresses an array of floats with at most 256 distinct values as a dictionary and bit-packed indices.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundDictionary(value_count).
+	* @return The number of bytes stored in out, or 0 if the array holds more than 256 distinct values.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Values are told apart by their bits, so 0.0 and -0.0 or different NaNs are different entries. Each value costs as many bits as needed to index the dictionary. Use DecodeDictionary to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeDictionary(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses an array of floats compressed with EncodeDictionary.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeDictionary(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodeRLE in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundRLE(size_t value_count) noexcept
+	{
+		return value_count * 4 + 4 + value_count / 0x7FFFFFFF * 4;
+	}
+
+	/** @brief Compresses an array of floats as runs of repeated values.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundRLE(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Runs of 3 or more bitwise identical values are stored as a length and a value, shorter runs are copied verbatim. This suits step functions such as setpoint logs. Use DecodeRLE to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeRLE(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses an array of floats compressed with EncodeRLE.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeRLE(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodeDowncast in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundDowncast(size_t value_count) noexcept
+	{
+		return value_count * 4 + (value_count + 1023) / 1024;
+	}
+
+	/** @brief Compresses an array of floats by storing blocks that hold narrower types at their native width.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundDowncast(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Each block of 1024 values is tagged and stored as 8-bit or 16-bit integers, half precision or bfloat16 floats when every value converts back bit for bit, and as 32-bit floats otherwise.
+	* Half precision is only detected when F16C is enabled at compile time. Use DecodeDowncast to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeDowncast(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses an array of floats compressed with EncodeDowncast.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeDowncast(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Identifies the codec used by EncodeAuto. It is stored in the first byte of the compressed data.
+	*/
+	enum class Format : uint8_t
+	{
+		Default,
+		Quick,
+		Compact,
+		Chimp,
+		ALP,
+		Dictionary,
+		RLE,
+		Downcast,
+	};
+
+	/** @brief Returns the size of an array compressed with EncodeAuto in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundAuto(size_t value_count) noexcept
+	{
+		size_t r = UpperBoundChimp(value_count);
+		if (r < UpperBoundALP(value_count))
+			r = UpperBoundALP(value_count);
+		if (r < UpperBoundDictionary(value_count))
+			r = UpperBoundDictionary(value_count);
+		if (r < UpperBoundRLE(value_count))
+			r = UpperBoundRLE(value_count);
+		if (r < UpperBoundDowncast(value_count))
+			r = UpperBoundDowncast(value_count);
+		return r + 1;
+	}
+
+	/** @brief Compresses an array of floats with the codec that suits it best.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundAuto(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note The predictor based codecs are compared on a few runs of 1024 values spread over the array. The dictionary codec is picked whenever the whole array has few enough distinct values to make it smaller.
+	* The chosen Format is stored in the first byte. Use DecodeAuto to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeAuto(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses an array of floats compressed with EncodeAuto.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeAuto(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of the buffer Transcode needs to convert to a given codec, which includes its working space.
+	* @param target_format The codec to convert to.
+	* @param value_count The number of floats to transcode.
+	* @return The size of the buffer, in bytes. Only Format::Dictionary and Format::RLE need working space, the other codecs need their own upper bound.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundTranscode(Format target_format, size_t value_count) noexcept
+	{
+		switch (target_format)
+		{
+		case Format::Compact:
+			return UpperBoundCompact(value_count);
+		case Format::Chimp:
+			return UpperBoundChimp(value_count);
+		case Format::ALP:
+			return UpperBoundALP(value_count);
+		case Format::Dictionary:
+			return UpperBoundDictionary(value_count) + 31 + value_count * 4;
+		case Format::RLE:
+			return UpperBoundRLE(value_count) + 31 + value_count * 4;
+		case Format::Downcast:
+			return UpperBoundDowncast(value_count);
+		default:
+			return UpperBound(value_count);
+		}
+	}
+
+	/** @brief Returns the size of the buffer Transcode needs for any conversion, which includes its working space.
+	* @param value_count The number of floats to transcode.
+	* @return The size of the buffer, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundTranscode(size_t value_count) noexcept
+	{
+		return UpperBoundAuto(value_count) + 31 + value_count * 4;
+	}
+
+	/** @brief Converts an array of floats compressed with one codec to another.
+	* @param source_format The codec of the compressed data.
+	* @param target_format The codec to convert to.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats in the compressed data.
+	* @param out A pointer to a buffer where the converted data will be stored. The size of this buffer must be set to UpperBoundTranscode(target_format, value_count).
+	* @return The number of bytes stored in out, or SIZE_MAX when the target codec does not apply to the values.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Conversions between Format::Default and Format::Quick run block by block: each block of 8 decoded values goes straight from the decoder
+	* registers into the encoder, without an intermediate buffer. Other conversions decode and encode 1024 values at a time through a buffer on the
+	* stack, except the ones to Format::Dictionary and Format::RLE, which decode the whole array into the end of out first.
+	* The output carries no tag byte, it can be decoded directly with the decoder of target_format.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL Transcode(Format source_format, Format target_format, const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodeFixedRate, which is always the same for a given rate.
+	* @param value_count The number of floats to compress.
+	* @param rate The number of bits per value, from 1 to 32.
+	* @return The size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundFixedRate(size_t value_count, uint32_t rate) noexcept
+	{
+		return (value_count + 15) / 16 * rate * 2;
+	}
+
+	/** @brief Lossily compresses an array of floats so that every block of 16 values takes exactly rate * 2 bytes.
+	* @param values A pointer to the array. Every value must be finite.
+	* @param value_count The number of floats to compress.
+	* @param rate The number of bits per value, from 1 to 32.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundFixedRate(value_count, rate).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Follows zfp: each block is scaled to integers with a common exponent, decorrelated with a 4x4 lifting transform and coded bit plane by bit plane until its budget runs out.
+	* Since block k starts at byte k * rate * 2, DecodeBlock decompresses it without an index. Use DecodeFixedRate to get the whole array back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeFixedRate(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint32_t rate, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses an array of floats compressed with EncodeFixedRate.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param rate The rate passed to EncodeFixedRate.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	*/
+	void VECTOR_CODEC_CALL DecodeFixedRate(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, uint32_t rate, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses a single block of 16 values from an array compressed with EncodeFixedRate.
+	* @param compressed A pointer to the compressed data.
+	* @param rate The rate passed to EncodeFixedRate.
+	* @param block_index The index of the block, covering values [block_index * 16, block_index * 16 + 16).
+	* @param out A pointer to an array of 16 floats where the decompressed values will be stored.
+	* @note The values of the last block past the end of the array are unspecified.
+	*/
+	void VECTOR_CODEC_CALL DecodeBlock(const uint8_t* VECTOR_CODEC_RESTRICT compressed, uint32_t rate, size_t block_index, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of the buffer EncodeToBudget needs, which includes its working space.
+	* @param value_count The number of floats to compress.
+	* @return The size of the buffer, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundToBudget(size_t value_count) noexcept
+	{
+		return UpperBound(value_count) + value_count * 4 + (value_count + 1023) / 1024 * 48 + 8;
+	}
+
+	/** @brief Lossily compresses an array of floats into at most target_bytes, losing as little precision as possible.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param target_bytes The largest acceptable size of the compressed data.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundToBudget(value_count).
+	* @return The number of bytes stored in out, at most target_bytes, or 0 if the array does not fit even at the lowest precision.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Each block of 1024 values keeps 23, 15, 7 or 0 mantissa bits, rounded to nearest, which lets Encode drop whole trailing bytes.
+	* The per-block precisions minimize the total squared error for the budget and are found by bisection on a Lagrange multiplier over the measured sizes.
+	* The result is an ordinary Encode stream, use Decode to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeToBudget(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, size_t target_bytes, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodeProgressive in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundProgressive(size_t value_count) noexcept
+	{
+		return 32 + UpperBound(value_count) + 8;
+	}
+
+	/** @brief Compresses an array of floats so that any prefix of the output decodes to an approximation of it.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundProgressive(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note Uses the predictor and the byte size classes of Encode, but stores the residual bytes in significance order: the headers, then the most significant byte of every residual, and so on down to the least significant ones.
+	* Since residuals are XORs, each byte of a value only depends on the same byte of the residuals. Use DecodeProgressive to get the data back.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodeProgressive(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Decompresses the best approximation of an array of floats from a prefix of the output of EncodeProgressive.
+	* @param compressed A pointer to the compressed data.
+	* @param value_count The number of floats to decompress.
+	* @param bytes_available The length of the prefix of the compressed data that has been received.
+	* @param out A pointer to an array where the decompressed values will be stored.
+	* @return The number of leading bytes that are exact in every value, from 0 to 4. When it is 4, out holds the original array.
+	* @note This function does NOT perform bounds checking on out, be careful to properly size it in relation to value_count.
+	* @note Values whose bytes are missing are rounded to the middle of the range they are known to lie in. Values whose most significant byte is missing are set to zero.
+	*/
+	uint32_t VECTOR_CODEC_CALL DecodeProgressive(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, size_t bytes_available, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Returns the size of an array compressed with EncodePlot in the worst case.
+	* @param value_count The number of floats to compress.
+	* @return The maximum size of the compressed data, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundPlot(size_t value_count) noexcept
+	{
+		size_t blocks = (value_count + 1023) / 1024;
+		size_t size = 8 + blocks * 8 + (value_count / 1024) * UpperBound(1024) + UpperBound(value_count % 1024);
+		for (; blocks > 1; blocks = (blocks + 1) / 2)
+			size += blocks * 16;
+		return size + blocks * 16;
+	}
+
+	/** @brief Compresses an array of floats along with a min/max pyramid for fast plotting.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to compress.
+	* @param out A pointer to a buffer where the compressed array will be stored. The size of this buffer must be set to UpperBoundPlot(value_count).
+	* @return The number of bytes stored in out.
+	* @note This function does NOT perform bounds checking on out.
+	* @note The values are split into blocks of 1024, each compressed like Encode. The min, max, first and last value of every block are recorded while it
+	* is encoded and merged pairwise into coarser levels. Each block of 4096 raw bytes costs an 8-byte offset and about two 16-byte nodes over all levels,
+	* so about 40 bytes or 1% of the raw size. Use DecodeForPlot to query it.
+	*/
+	[[nodiscard]] size_t VECTOR_CODEC_CALL EncodePlot(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief Computes the M4 aggregates of a range of values compressed with EncodePlot.
+	* @param compressed A pointer to the compressed data.
+	* @param t0 The index of the first value in the range.
+	* @param t1 The index one past the last value in the range.
+	* @param pixels The number of buckets the range is split into. Bucket p covers [t0 + (t1 - t0) * p / pixels, t0 + (t1 - t0) * (p + 1) / pixels).
+	* @param out A pointer to an array of pixels * 4 floats where the min, max, first and last value of each bucket will be stored. Empty buckets are set to NaN.
+	* @note The aggregates are exact. Whole blocks are taken from the pyramid, only the blocks that a bucket boundary falls in are decompressed.
+	* @note min and max skip NaN, so a bucket of NaN only has min set to +infinity and max set to -infinity. first and last are the values as stored.
+	*/
+	void VECTOR_CODEC_CALL DecodeForPlot(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t t0, size_t t1, size_t pixels, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief The size of the footer at the end of an appendable stream, which holds the predictor state and the counts.
+	*/
+	constexpr size_t AppendFooterSize = 128 * 4 + 32 * 2 + 16;
+
+	/** @brief Returns how many bytes an appendable stream may grow by when value_count floats are appended to it.
+	* @param value_count The number of floats to append.
+	* @return The maximum growth of the stream, in bytes.
+	*/
+	constexpr size_t VECTOR_CODEC_CALL UpperBoundAppend(size_t value_count) noexcept
+	{
+		return 8 + UpperBound(value_count);
+	}
+
+	/** @brief An appendable stream: a sequence of segments followed by the footer.
+	*/
+	struct AppendStream
+	{
+		uint8_t* data;
+		size_t size;
+		size_t value_count;
+	};
+
+	/** @brief Opens an appendable stream, or creates an empty one.
+	* @param compressed A pointer to the stream.
+	* @param compressed_size The size of the stream in bytes, or 0 to create an empty stream, in which case compressed must hold AppendFooterSize bytes.
+	* @return The stream, with its size and the number of values it holds.
+	*/
+	AppendStream VECTOR_CODEC_CALL OpenForAppend(uint8_t* compressed, size_t compressed_size) noexcept;
+
+	/** @brief Compresses an array of floats at the end of an appendable stream, without touching the values already in it.
+	* @param stream A stream returned by OpenForAppend, updated to its new size and value count.
+	* @param values A pointer to the array.
+	* @param value_count The number of floats to append.
+	* @return The new size of the stream, in bytes.
+	* @note This function does NOT perform bounds checking, stream.data must hold stream.size + UpperBoundAppend(value_count) bytes.
+	* @note Each call adds a segment with its own value count and headers, encoded like Encode but starting from the predictor state kept in the
+	* footer. The segment overwrites the footer and is followed by the updated one, so appending costs O(value_count) regardless of the stream size.
+	*/
+	size_t VECTOR_CODEC_CALL Append(AppendStream& stream, const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept;
+
+	/** @brief Decompresses an appendable stream.
+	* @param compressed A pointer to the stream.
+	* @param compressed_size The size of the stream in bytes.
+	* @param out A pointer to an array where the decompressed values will be stored, which must hold OpenForAppend(...).value_count floats.
+	*/
+	void VECTOR_CODEC_CALL DecodeAppendable(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t compressed_size, float* VECTOR_CODEC_RESTRICT out) noexcept;
+
+	/** @brief A read-only array of floats stored compressed in blocks of up to block_size values, which are decoded on demand.
+	* @tparam T The type of the values, only float is supported.
+	* @tparam Allocator The allocator used for the compressed bytes, rebound to uint8_t.
+	* @note Each block is compressed like Encode and found through a table holding the end offset and end index of every block, so random access only
+	* decodes the block that holds the value. Blocks are full except where arrays were joined or cut by concat and slice, which copy whole blocks.
+	* @note Iterators hold their own decoded block: a sequential pass decodes every block exactly once and iterators can be used from several threads.
+	* operator[] shares a single cached block in the array, so it must not be called concurrently.
+	*/
+	template <typename T, typename Allocator = std::allocator<uint8_t>>
+	class CompressedArray
+	{
+		static_assert(std::is_same<T, float>::value, "CompressedArray only supports float.");
+
+		using ByteAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>;
+		using ByteTraits = std::allocator_traits<ByteAllocator>;
+
+		// Encode may write up to 32 bytes past the end of its output and Decode may read a few bytes past the end of its input.
+		static constexpr size_t padding = 32;
+		static constexpr size_t entry_size = 16;
+
+	public:
+		using value_type = T;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using allocator_type = Allocator;
+
+		static constexpr size_t block_size = 256;
+
+		class const_iterator
+		{
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = T;
+			using difference_type = ptrdiff_t;
+			using pointer = const T*;
+			using reference = T;
+
+			const_iterator() noexcept = default;
+
+			const_iterator(const CompressedArray* array, size_t index) noexcept :
+				array(array), index(index)
+			{
+			}
+
+			T operator*() const noexcept
+			{
+				if (index - cached_first >= cached_length)
+				{
+					const size_t block_index = array->find_block(index);
+					array->decode_block(block_index, block);
+					cached_first = array->block_first(block_index);
+					cached_length = array->block_length(block_index);
+				}
+				return block[index - cached_first];
+			}
+
+			T operator[](difference_type offset) const noexcept { return *(*this + offset); }
+
+			const_iterator& operator++() noexcept { ++index; return *this; }
+			const_iterator& operator--() noexcept { --index; return *this; }
+			const_iterator operator++(int) noexcept { const_iterator r = *this; ++index; return r; }
+			const_iterator operator--(int) noexcept { const_iterator r = *this; --index; return r; }
+			const_iterator& operator+=(difference_type offset) noexcept { index += offset; return *this; }
+			const_iterator& operator-=(difference_type offset) noexcept { index -= offset; return *this; }
+			const_iterator operator+(difference_type offset) const noexcept { const_iterator r = *this; return r += offset; }
+			const_iterator operator-(difference_type offset) const noexcept { const_iterator r = *this; return r -= offset; }
+			friend const_iterator operator+(difference_type offset, const const_iterator& it) noexcept { return it + offset; }
+			difference_type operator-(const const_iterator& other) const noexcept { return (difference_type)(index - other.index); }
+
+			bool operator==(const const_iterator& other) const noexcept { return index == other.index; }
+			bool operator!=(const const_iterator& other) const noexcept { return index != other.index; }
+			bool operator<(const const_iterator& other) const noexcept { return index < other.index; }
+			bool operator>(const const_iterator& other) const noexcept { return index > other.index; }
+			bool operator<=(const const_iterator& other) const noexcept { return index <= other.index; }
+			bool operator>=(const const_iterator& other) const noexcept { return index >= other.index; }
+
+		private:
+			const CompressedArray* array = nullptr;
+			size_t index = 0;
+			mutable size_t cached_first = 0;
+			mutable size_t cached_length = 0;
+			alignas(32) mutable T block[block_size];
+		};
+
+		using iterator = const_iterator;
+
+		explicit CompressedArray(const Allocator& allocator = Allocator()) noexcept :
+			allocator(allocator)
+		{
+		}
+
+		// The blocks are encoded twice, once to size the buffer and once in place, so that a single allocation of the exact size is made.
+		CompressedArray(const T* values, size_t value_count, const Allocator& allocator = Allocator()) :
+			allocator(allocator)
+		{
+			const size_t blocks = (value_count + block_size - 1) / block_size;
+			alignas(32) uint8_t scratch[UpperBound(block_size)];
+			size_t stream_bytes = 0;
+			for (size_t i = 0; i != blocks; ++i)
+				stream_bytes += Encode(values + i * block_size, value_count - i * block_size < block_size ? value_count - i * block_size : block_size, scratch);
+			allocate(blocks, stream_bytes);
+			uint64_t offset = 0;
+			for (size_t i = 0; i != blocks; ++i)
+			{
+				const size_t length = value_count - i * block_size < block_size ? value_count - i * block_size : block_size;
+				offset += Encode(values + i * block_size, length, streams() + offset);
+				set_entry(i, offset, i * block_size + length);
+			}
+			this->value_count = value_count;
+		}
+
+		CompressedArray(CompressedArray&& other) noexcept :
+			allocator(std::move(other.allocator)),
+			bytes(std::exchange(other.bytes, nullptr)),
+			byte_count(std::exchange(other.byte_count, 0)),
+			blocks(std::exchange(other.blocks, 0)),
+			value_count(std::exchange(other.value_count, 0))
+		{
+		}
+
+		// The allocator always moves along with the buffer.
+		CompressedArray& operator=(CompressedArray&& other) noexcept
+		{
+			if (this != &other)
+			{
+				release();
+				allocator = std::move(other.allocator);
+				bytes = std::exchange(other.bytes, nullptr);
+				byte_count = std::exchange(other.byte_count, 0);
+				blocks = std::exchange(other.blocks, 0);
+				value_count = std::exchange(other.value_count, 0);
+				cached_length = 0;
+			}
+			return *this;
+		}
+
+		CompressedArray(const CompressedArray&) = delete;
+		CompressedArray& operator=(const CompressedArray&) = delete;
+
+		~CompressedArray()
+		{
+			release();
+		}
+
+		/** @brief Joins arrays end to end. The compressed blocks are copied as they are, with one memcpy per array.
+		*/
+		static CompressedArray concat(const CompressedArray* arrays, size_t array_count, const Allocator& allocator = Allocator())
+		{
+			CompressedArray r(allocator);
+			size_t blocks = 0, stream_bytes = 0;
+			for (size_t i = 0; i != array_count; ++i)
+			{
+				blocks += arrays[i].blocks;
+				stream_bytes += arrays[i].stream_size();
+			}
+			r.allocate(blocks, stream_bytes);
+			size_t block_index = 0;
+			for (size_t i = 0; i != array_count; ++i)
+			{
+				const CompressedArray& array = arrays[i];
+				const uint64_t offset = block_index != 0 ? r.end_offset(block_index - 1) : 0;
+				if (array.blocks != 0)
+					std::memcpy(r.streams() + offset, array.streams(), array.stream_size());
+				for (size_t j = 0; j != array.blocks; ++j, ++block_index)
+					r.set_entry(block_index, offset + array.end_offset(j), r.value_count + array.block_first(j) + array.block_length(j));
+				r.value_count += array.value_count;
+			}
+			return r;
+		}
+
+		/** @brief Returns the values in [first, first + count). The blocks inside the range are copied, only the blocks cut by its ends are re-encoded.
+		*/
+		CompressedArray slice(size_t first, size_t count) const
+		{
+			CompressedArray r{ allocator_type(allocator) };
+			if (count == 0)
+				return r;
+			const size_t last = first + count;
+			const size_t first_block = find_block(first);
+			const size_t last_block = find_block(last - 1);
+			alignas(32) uint8_t edges[2][UpperBound(block_size)];
+			size_t edge_sizes[2] = {};
+			size_t edge_ends[2] = {};
+			size_t inner_first = first_block, inner_last = last_block + 1;
+			// Re-encodes the part of a block that falls in the range, unless the block is entirely in it.
+			const auto cut = [&](size_t block_index, size_t side)
+			{
+				const size_t begin = block_first(block_index);
+				const size_t end = begin + block_length(block_index);
+				const size_t cut_first = first > begin ? first : begin;
+				const size_t cut_last = last < end ? last : end;
+				if (cut_first == begin && cut_last == end)
+					return false;
+				alignas(32) T values[block_size];
+				decode_block(block_index, values);
+				edge_sizes[side] = Encode(values + (cut_first - begin), cut_last - cut_first, edges[side]);
+				edge_ends[side] = cut_last - first;
+				return true;
+			};
+			if (cut(first_block, 0))
+				++inner_first;
+			if (last_block != first_block && cut(last_block, 1))
+				--inner_last;
+			if (inner_first > inner_last)
+				inner_first = inner_last;
+			const size_t inner_begin = inner_first != 0 ? end_offset(inner_first - 1) : 0;
+			const size_t inner_bytes = inner_first != inner_last ? end_offset(inner_last - 1) - inner_begin : 0;
+			r.allocate((edge_sizes[0] != 0) + (inner_last - inner_first) + (edge_sizes[1] != 0), edge_sizes[0] + inner_bytes + edge_sizes[1]);
+			uint64_t offset = 0;
+			size_t block_index = 0;
+			if (edge_sizes[0] != 0)
+			{
+				std::memcpy(r.streams(), edges[0], edge_sizes[0]);
+				offset = edge_sizes[0];
+				r.set_entry(block_index++, offset, edge_ends[0]);
+			}
+			if (inner_bytes != 0)
+				std::memcpy(r.streams() + offset, streams() + inner_begin, inner_bytes);
+			for (size_t i = inner_first; i != inner_last; ++i)
+				r.set_entry(block_index++, offset + end_offset(i) - inner_begin, block_first(i) + block_length(i) - first);
+			offset += inner_bytes;
+			if (edge_sizes[1] != 0)
+			{
+				std::memcpy(r.streams() + offset, edges[1], edge_sizes[1]);
+				r.set_entry(block_index++, offset + edge_sizes[1], edge_ends[1]);
+			}
+			r.value_count = count;
+			return r;
+		}
+
+		size_t size() const noexcept { return value_count; }
+		bool empty() const noexcept { return value_count == 0; }
+		size_t block_count() const noexcept { return blocks; }
+		size_t block_first(size_t block_index) const noexcept { return block_index != 0 ? end_index(block_index - 1) : 0; }
+		size_t block_length(size_t block_index) const noexcept { return end_index(block_index) - block_first(block_index); }
+		size_t compressed_size() const noexcept { return byte_count; }
+		const uint8_t* data() const noexcept { return bytes; }
+		allocator_type get_allocator() const { return allocator_type(allocator); }
+
+		/** @brief Returns the index of the block that holds the value at index. Arrays that were never cut take the first guess.
+		*/
+		size_t find_block(size_t index) const noexcept
+		{
+			size_t low = index / block_size;
+			if (low < blocks && block_first(low) <= index && index < end_index(low))
+				return low;
+			low = 0;
+			size_t high = blocks - 1;
+			while (low < high)
+			{
+				const size_t middle = low + (high - low) / 2;
+				if (end_index(middle) <= index)
+					low = middle + 1;
+				else
+					high = middle;
+			}
+			return low;
+		}
+
+		const_iterator begin() const noexcept { return const_iterator(this, 0); }
+		const_iterator end() const noexcept { return const_iterator(this, value_count); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+
+		T operator[](size_t index) const noexcept
+		{
+			if (index - cached_first >= cached_length)
+			{
+				const size_t block_index = find_block(index);
+				decode_block(block_index, cache);
+				cached_first = block_first(block_index);
+				cached_length = block_length(block_index);
+			}
+			return cache[index - cached_first];
+		}
+
+		/** @brief Decompresses the block_length(block_index) values of a block, starting at block_first(block_index), into out.
+		*/
+		void decode_block(size_t block_index, T* out) const noexcept
+		{
+			Decode(streams() + (block_index != 0 ? end_offset(block_index - 1) : 0), block_length(block_index), out);
+		}
+
+		/** @brief Decompresses the whole array into out, which must hold size() values.
+		*/
+		void decode(T* out) const noexcept
+		{
+			for (size_t i = 0; i != blocks; ++i)
+				decode_block(i, out + block_first(i));
+		}
+
+	private:
+		// Layout: an entry per block with its end offset in the streams and its end index, then the streams.
+		void allocate(size_t block_count, size_t stream_bytes)
+		{
+			byte_count = block_count * entry_size + stream_bytes;
+			bytes = ByteTraits::allocate(allocator, byte_count + padding);
+			blocks = block_count;
+			std::memset(bytes + byte_count, 0, padding);
+		}
+
+		uint8_t* streams() const noexcept { return bytes + blocks * entry_size; }
+		size_t stream_size() const noexcept { return byte_count - blocks * entry_size; }
+
+		uint64_t end_offset(size_t block_index) const noexcept
+		{
+			uint64_t r;
+			std::memcpy(&r, bytes + block_index * entry_size, 8);
+			return r;
+		}
+
+		size_t end_index(size_t block_index) const noexcept
+		{
+			uint64_t r;
+			std::memcpy(&r, bytes + block_index * entry_size + 8, 8);
+			return (size_t)r;
+		}
+
+		void set_entry(size_t block_index, uint64_t offset, uint64_t index) noexcept
+		{
+			std::memcpy(bytes + block_index * entry_size, &offset, 8);
+			std::memcpy(bytes + block_index * entry_size + 8, &index, 8);
+		}
+
+		void release() noexcept
+		{
+			if (bytes != nullptr)
+				ByteTraits::deallocate(allocator, bytes, byte_count + padding);
+			bytes = nullptr;
+		}
+
+		ByteAllocator allocator;
+		uint8_t* bytes = nullptr;
+		size_t byte_count = 0;
+		size_t blocks = 0;
+		size_t value_count = 0;
+		mutable size_t cached_first = 0;
+		mutable size_t cached_length = 0;
+		alignas(32) mutable T cache[block_size];
+	};
+
+	/** @brief An array of floats stored compressed in blocks of block_size values that supports sparse updates.
+	* @tparam T The type of the values, only float is supported.
+	* @tparam Allocator The allocator used for the compressed blocks, rebound as needed.
+	* @note Every block has its own buffer and a log of up to log_capacity pending writes. A write only appends to the log of its block. When the
+	* log is full, the block is decoded, the log is applied and the block is re-encoded, so the cost of a write is bounded by the block size.
+	* Reads overlay the log on the decoded block. Call compact to apply every log.
+	* @note get and operator[] share a single cached block in the array, so the array must not be used from several threads at once.
+	*/
+	template <typename T, typename Allocator = std::allocator<uint8_t>>
+	class MutableCompressedArray
+	{
+		static_assert(std::is_same<T, float>::value, "MutableCompressedArray only supports float.");
+
+		using ByteAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>;
+		using ByteTraits = std::allocator_traits<ByteAllocator>;
+
+		static constexpr size_t padding = 32;
+
+	public:
+		using value_type = T;
+		using size_type = size_t;
+		using allocator_type = Allocator;
+
+		static constexpr size_t block_size = 256;
+		static constexpr uint32_t log_capacity = 16;
+
+	private:
+		struct Block
+		{
+			uint8_t* bytes;
+			uint32_t byte_count;
+			uint32_t log_count;
+			uint8_t log_offsets[log_capacity];
+			T log_values[log_capacity];
+		};
+
+		using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+
+	public:
+		explicit MutableCompressedArray(const Allocator& allocator = Allocator()) noexcept :
+			allocator(allocator), blocks(BlockAllocator(allocator))
+		{
+		}
+
+		MutableCompressedArray(const T* values, size_t value_count, const Allocator& allocator = Allocator()) :
+			allocator(allocator), blocks(BlockAllocator(allocator)), value_count(value_count)
+		{
+			// The destructor does not run if this throws, so the blocks stored so far are freed here.
+			blocks.reserve(block_count());
+			try
+			{
+				for (size_t i = 0; i != block_count(); ++i)
+				{
+					Block block = { nullptr, 0, 0, {}, {} };
+					store(block, values + i * block_size, block_length(i));
+					blocks.push_back(block);
+				}
+			}
+			catch (...)
+			{
+				release();
+				throw;
+			}
+		}
+
+		MutableCompressedArray(MutableCompressedArray&& other) noexcept :
+			allocator(std::move(other.allocator)),
+			blocks(std::move(other.blocks)),
+			value_count(std::exchange(other.value_count, 0)),
+			cached_block(std::exchange(other.cached_block, SIZE_MAX))
+		{
+			std::memcpy(cache, other.cache, sizeof(cache));
+			other.blocks.clear();
+		}
+
+		// The allocator always moves along with the blocks.
+		MutableCompressedArray& operator=(MutableCompressedArray&& other) noexcept
+		{
+			if (this != &other)
+			{
+				release();
+				allocator = std::move(other.allocator);
+				blocks = std::move(other.blocks);
+				value_count = std::exchange(other.value_count, 0);
+				cached_block = SIZE_MAX;
+				other.blocks.clear();
+			}
+			return *this;
+		}
+
+		MutableCompressedArray(const MutableCompressedArray&) = delete;
+		MutableCompressedArray& operator=(const MutableCompressedArray&) = delete;
+
+		~MutableCompressedArray()
+		{
+			release();
+		}
+
+		size_t size() const noexcept { return value_count; }
+		bool empty() const noexcept { return value_count == 0; }
+		size_t block_count() const noexcept { return (value_count + block_size - 1) / block_size; }
+		size_t block_length(size_t block_index) const noexcept { return value_count - block_index * block_size < block_size ? value_count - block_index * block_size : block_size; }
+		allocator_type get_allocator() const { return allocator_type(allocator); }
+
+		/** @brief Returns the size of the compressed blocks plus the pending writes, in bytes.
+		*/
+		size_t compressed_size() const noexcept
+		{
+			size_t size = 0;
+			for (const Block& block : blocks)
+				size += block.byte_count + block.log_count * (1 + sizeof(T));
+			return size;
+		}
+
+		T get(size_t index) const noexcept
+		{
+			const size_t block_index = index / block_size;
+			if (block_index != cached_block)
+			{
+				decode_block(block_index, cache);
+				cached_block = block_index;
+			}
+			return cache[index % block_size];
+		}
+
+		T operator[](size_t index) const noexcept { return get(index); }
+
+		void set(size_t index, T value)
+		{
+			const size_t block_index = index / block_size;
+			const uint8_t offset = (uint8_t)(index % block_size);
+			Block& block = blocks[block_index];
+			if (block_index == cached_block)
+				cache[offset] = value;
+			for (uint32_t i = 0; i != block.log_count; ++i)
+			{
+				if (block.log_offsets[i] == offset)
+				{
+					block.log_values[i] = value;
+					return;
+				}
+			}
+			if (block.log_count == log_capacity)
+				merge(block_index);
+			block.log_offsets[block.log_count] = offset;
+			block.log_values[block.log_count] = value;
+			++block.log_count;
+		}
+
+		/** @brief Re-encodes every block with pending writes.
+		*/
+		void compact()
+		{
+			for (size_t i = 0; i != block_count(); ++i)
+				if (blocks[i].log_count != 0)
+					merge(i);
+		}
+
+		/** @brief Decompresses block_length(block_index) values, starting at block_index * block_size, into out, with the pending writes applied.
+		*/
+		void decode_block(size_t block_index, T* out) const noexcept
+		{
+			const Block& block = blocks[block_index];
+			Decode(block.bytes, block_length(block_index), out);
+			for (uint32_t i = 0; i != block.log_count; ++i)
+				out[block.log_offsets[i]] = block.log_values[i];
+		}
+
+		/** @brief Decompresses the whole array into out, which must hold size() values.
+		*/
+		void decode(T* out) const noexcept
+		{
+			for (size_t i = 0; i != block_count(); ++i)
+				decode_block(i, out + i * block_size);
+		}
+
+	private:
+		void merge(size_t block_index)
+		{
+			alignas(32) T values[block_size];
+			if (block_index == cached_block)
+				std::memcpy(values, cache, sizeof(values));
+			else
+				decode_block(block_index, values);
+			store(blocks[block_index], values, block_length(block_index));
+		}
+
+		// The new buffer is allocated before the old one is freed, so the block is left untouched if the allocation throws.
+		void store(Block& block, const T* values, size_t length)
+		{
+			alignas(32) uint8_t scratch[UpperBound(block_size)];
+			const size_t byte_count = Encode(values, length, scratch);
+			uint8_t* const bytes = ByteTraits::allocate(allocator, byte_count + padding);
+			std::memcpy(bytes, scratch, byte_count);
+			std::memset(bytes + byte_count, 0, padding);
+			if (block.bytes != nullptr)
+				ByteTraits::deallocate(allocator, block.bytes, block.byte_count + padding);
+			block.bytes = bytes;
+			block.byte_count = (uint32_t)byte_count;
+			block.log_count = 0;
+		}
+
+		void release() noexcept
+		{
+			for (Block& block : blocks)
+				ByteTraits::deallocate(allocator, block.bytes, block.byte_count + padding);
+			blocks.clear();
+		}
+
+		ByteAllocator allocator;
+		std::vector<Block, BlockAllocator> blocks;
+		size_t value_count = 0;
+		mutable size_t cached_block = SIZE_MAX;
+		alignas(32) mutable T cache[block_size];
+	};
+
+	/** @brief A cache of decoded CompressedArray blocks shared by reader threads, with a budget in bytes.
+	* @note Blocks are keyed by (array id, block index) and a hash of the key picks a set of 8 ways, the sets acting as shards. A hit only touches
+	* atomics: the reader pins the way, copies the block out and unpins it. A miss locks its set, evicts an unpinned way with CLOCK and decodes into it.
+	* @note Array ids are chosen by the caller and must be unique among live arrays. Call Invalidate before an id is reused.
+	*/
+	class BlockCache
+	{
+		static constexpr size_t block_size = CompressedArray<float>::block_size;
+		static constexpr uint32_t Ways = 8;
+		static constexpr uint32_t Busy = 1U << 31;
+		static constexpr uint32_t Empty = 1U << 30;
+		static constexpr uint32_t Referenced = 1U << 29;
+		static constexpr uint32_t Pins = Referenced - 1;
+
+		// The state packs the pin count with the flags: Busy while the way is refilled, Empty until it is first filled, and Referenced for CLOCK.
+		struct alignas(64) Way
+		{
+			std::atomic<uint32_t> state{ Empty };
+			std::atomic<uint64_t> array_id{ 0 };
+			std::atomic<size_t> block_index{ 0 };
+			float values[block_size];
+		};
+
+		struct Set
+		{
+			std::mutex mutex;
+			uint32_t hand = 0;
+		};
+
+	public:
+		explicit BlockCache(size_t byte_budget) :
+			set_count(byte_budget / (sizeof(Way) * Ways) != 0 ? byte_budget / (sizeof(Way) * Ways) : 1),
+			ways(new Way[set_count * Ways]),
+			sets(new Set[set_count])
+		{
+		}
+
+		/** @brief Copies block block_index of array into out, which must hold array.block_length(block_index) values, decoding it only on a miss.
+		*/
+		template <typename Allocator>
+		void Read(const CompressedArray<float, Allocator>& array, uint64_t array_id, size_t block_index, float* out)
+		{
+			const size_t length = array.block_length(block_index);
+			const size_t set_index = SetIndex(array_id, block_index);
+			Way* const set_ways = ways.get() + set_index * Ways;
+			if (TryRead(set_ways, array_id, block_index, out, length))
+				return;
+			Set& set = sets[set_index];
+			std::lock_guard<std::mutex> lock(set.mutex);
+			if (TryRead(set_ways, array_id, block_index, out, length))
+				return;
+			Way* const victim = Evict(set, set_ways);
+			if (victim == nullptr)
+			{
+				array.decode_block(block_index, out);
+				return;
+			}
+			victim->array_id.store(array_id, std::memory_order_relaxed);
+			victim->block_index.store(block_index, std::memory_order_relaxed);
+			array.decode_block(block_index, victim->values);
+			victim->state.store(Referenced, std::memory_order_release);
+			// Evictions hold the set lock, so the way can be read without pinning it.
+			std::memcpy(out, victim->values, length * sizeof(float));
+		}
+
+		/** @brief Drops every cached block of an array, waiting for in-flight reads of them to finish.
+		*/
+		void Invalidate(uint64_t array_id)
+		{
+			for (size_t i = 0; i != set_count; ++i)
+			{
+				std::lock_guard<std::mutex> lock(sets[i].mutex);
+				for (uint32_t j = 0; j != Ways; ++j)
+				{
+					Way& way = ways[i * Ways + j];
+					uint32_t state = way.state.load(std::memory_order_relaxed);
+					if ((state & Empty) != 0 || way.array_id.load(std::memory_order_relaxed) != array_id)
+						continue;
+					while ((state & Pins) != 0 || !way.state.compare_exchange_weak(state, Empty, std::memory_order_acquire, std::memory_order_relaxed))
+						state = way.state.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		size_t Capacity() const noexcept { return set_count * Ways * block_size * sizeof(float); }
+
+	private:
+		size_t SetIndex(uint64_t array_id, size_t block_index) const noexcept
+		{
+			uint64_t hash = (array_id * 0x9E3779B97F4A7C15 + block_index) * 0xBF58476D1CE4E5B9;
+			hash ^= hash >> 31;
+			return (size_t)(hash % set_count);
+		}
+
+		// The key is checked again once the way is pinned, since it can only change while the way is Busy and unpinned.
+		static bool TryRead(Way* set_ways, uint64_t array_id, size_t block_index, float* out, size_t length) noexcept
+		{
+			for (uint32_t i = 0; i != Ways; ++i)
+			{
+				Way& way = set_ways[i];
+				if (way.block_index.load(std::memory_order_relaxed) != block_index || way.array_id.load(std::memory_order_relaxed) != array_id)
+					continue;
+				uint32_t state = way.state.load(std::memory_order_relaxed);
+				bool pinned = false;
+				while ((state & (Busy | Empty)) == 0 && !(pinned = way.state.compare_exchange_weak(state, (state + 1) | Referenced, std::memory_order_acquire, std::memory_order_relaxed)))
+					;
+				if (!pinned)
+					continue;
+				const bool hit = way.block_index.load(std::memory_order_relaxed) == block_index && way.array_id.load(std::memory_order_relaxed) == array_id;
+				if (hit)
+					std::memcpy(out, way.values, length * sizeof(float));
+				way.state.fetch_sub(1, std::memory_order_release);
+				if (hit)
+					return true;
+			}
+			return false;
+		}
+
+		// CLOCK: referenced ways get a second chance, pinned ways are skipped. Returns null when every way stays pinned for three sweeps.
+		static Way* Evict(Set& set, Way* set_ways) noexcept
+		{
+			for (uint32_t i = 0; i != Ways * 3; ++i)
+			{
+				Way& way = set_ways[set.hand];
+				set.hand = (set.hand + 1) % Ways;
+				uint32_t state = way.state.load(std::memory_order_relaxed);
+				if ((state & Pins) != 0)
+					continue;
+				if ((state & Referenced) != 0)
+				{
+					way.state.compare_exchange_strong(state, state & ~Referenced, std::memory_order_relaxed);
+					continue;
+				}
+				if (way.state.compare_exchange_strong(state, Busy, std::memory_order_acquire, std::memory_order_relaxed))
+					return &way;
+			}
+			return nullptr;
+		}
+
+		size_t set_count;
+		std::unique_ptr<Way[]> ways;
+		std::unique_ptr<Set[]> sets;
+	};
+
+	/** @brief A read-only range of virtual memory that shows the decompressed values of a CompressedArray, decoded on first touch.
+	* @note Experimental, Linux only. The range is registered with userfaultfd and a handler thread serves each fault by decoding the blocks that cover
+	* the faulting unit of fault_size bytes straight into place. Once more than resident_bytes are populated, the oldest unit is dropped with
+	* MADV_DONTNEED and decoded again if it is touched later. The array must outlive the mapping.
+	* @note Where userfaultfd is restricted to faults raised from user mode (vm.unprivileged_userfaultfd = 0 without CAP_SYS_PTRACE), a system call
+	* such as write, send or fwrite that reads an untouched page fails with EFAULT instead of faulting it in. Touch the range from user code first.
+	*/
+	class DecompressedMapping
+	{
+	public:
+		static constexpr size_t fault_size = 1 << 16;
+
+		DecompressedMapping() noexcept = default;
+		DecompressedMapping(DecompressedMapping&& other) noexcept = default;
+		DecompressedMapping& operator=(DecompressedMapping&& other) noexcept;
+		DecompressedMapping(const DecompressedMapping&) = delete;
+		DecompressedMapping& operator=(const DecompressedMapping&) = delete;
+		~DecompressedMapping();
+
+		/** @brief Maps array. The result converts to false if userfaultfd is not available, in which case the caller should decode the array instead.
+		* @param resident_bytes The budget of populated memory, rounded up to a whole fault unit. 0 keeps every unit once decoded.
+		*/
+		template <typename Allocator>
+		static DecompressedMapping Map(const CompressedArray<float, Allocator>& array, size_t resident_bytes = 0)
+		{
+			return Map(&array, array.size(), [](const void* context, size_t first, size_t count, float* out)
+			{
+				const auto& source = *(const CompressedArray<float, Allocator>*)context;
+				alignas(32) float block[CompressedArray<float, Allocator>::block_size];
+				for (size_t block_index = source.find_block(first); count != 0; ++block_index)
+				{
+					const size_t length = source.block_length(block_index);
+					const size_t skip = first - source.block_first(block_index);
+					const size_t n = length - skip < count ? length - skip : count;
+					if (n == length)
+					{
+						source.decode_block(block_index, out);
+					}
+					else
+					{
+						source.decode_block(block_index, block);
+						std::memcpy(out, block + skip, n * sizeof(float));
+					}
+					out += n;
+					first += n;
+					count -= n;
+				}
+			}, resident_bytes);
+		}
+
+		explicit operator bool() const noexcept { return state != nullptr; }
+
+		/** @brief The first value. Pages are mapped read-only, so writes through this pointer fault.
+		*/
+		const float* data() const noexcept;
+		size_t size() const noexcept;
+
+	private:
+		struct State;
+		using DecodeRange = void (*)(const void* context, size_t first, size_t count, float* out);
+
+		static DecompressedMapping Map(const void* context, size_t value_count, DecodeRange decode, size_t resident_bytes);
+
+		std::unique_ptr<State> state;
+	};
+
+	/** @brief Maps array through userfaultfd so that unmodified code can read it through a plain pointer. See DecompressedMapping.
+	*/
+	template <typename Allocator>
+	inline DecompressedMapping MapDecompressed(const CompressedArray<float, Allocator>& array, size_t resident_bytes = 0)
+	{
+		return DecompressedMapping::Map(array, resident_bytes);
+	}
+
+	/** @brief The type of the values of an array stored in an archive.
+	*/
+	enum class DataType : uint8_t
+	{
+		Float32,
+	};
+
+	constexpr uint32_t ArchiveMaxRank = 8;
+
+	/** @brief The metadata of an array stored in an archive.
+	*/
+	struct ArchiveEntry
+	{
+		const char* name;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t value_count;
+		uint64_t shape[ArchiveMaxRank];
+		uint32_t rank;
+		uint32_t checksum;
+		DataType type;
+		Format codec;
+	};
+
+	/** @brief Writes an archive: a file of named compressed arrays followed by an index of their metadata and a footer.
+	* @note Each array is compressed with EncodeAuto. The index records its name, type, shape, codec, position and a CRC32C checksum of the compressed bytes.
+	*/
+	class ArchiveWriter
+	{
+	public:
+		ArchiveWriter() noexcept = default;
+		ArchiveWriter(const ArchiveWriter&) = delete;
+		ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+		~ArchiveWriter()
+		{
+			(void)Close();
+		}
+
+		/** @brief Creates or truncates the archive at path. Returns false if the file cannot be opened.
+		*/
+		bool Open(const char* path) noexcept;
+
+		/** @brief Compresses and appends an array of floats with the given shape, whose product is the number of values. Returns false on I/O errors.
+		*/
+		bool Add(const char* name, const float* values, const uint64_t* shape, uint32_t rank);
+
+		/** @brief Writes the index and the footer and closes the file. Returns false if any write failed.
+		*/
+		bool Close() noexcept;
+
+	private:
+		std::FILE* file = nullptr;
+		uint64_t offset = 0;
+		uint64_t count = 0;
+		bool failed = false;
+		std::vector<uint8_t> index;
+		std::vector<uint8_t> buffer;
+	};
+
+	/** @brief A read-only view of an archive written by ArchiveWriter.
+	* @note Open maps the file into memory and only parses the footer and the index, so it does not depend on the size of the arrays.
+	* Read then touches the pages of a single array.
+	*/
+	class Archive
+	{
+	public:
+		Archive() noexcept = default;
+
+		Archive(Archive&& other) noexcept :
+			base(std::exchange(other.base, nullptr)),
+			size(std::exchange(other.size, 0)),
+			mapping(std::exchange(other.mapping, nullptr)),
+			entries(std::move(other.entries))
+		{
+		}
+
+		Archive& operator=(Archive&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Close();
+				base = std::exchange(other.base, nullptr);
+				size = std::exchange(other.size, 0);
+				mapping = std::exchange(other.mapping, nullptr);
+				entries = std::move(other.entries);
+			}
+			return *this;
+		}
+
+		Archive(const Archive&) = delete;
+		Archive& operator=(const Archive&) = delete;
+
+		~Archive()
+		{
+			Close();
+		}
+
+		/** @brief Maps the archive at path. The result converts to false if the file cannot be mapped or is not a valid archive.
+		*/
+		static Archive Open(const char* path);
+
+		explicit operator bool() const noexcept { return base != nullptr; }
+
+		/** @brief The number of arrays in the archive. Entries are sorted by name.
+		*/
+		size_t Count() const noexcept { return entries.size(); }
+		const ArchiveEntry& Entry(size_t index) const noexcept { return entries[index]; }
+
+		/** @brief Returns the entry of the array called name, or null if there is none.
+		*/
+		const ArchiveEntry* Find(const char* name) const noexcept;
+
+		/** @brief Decompresses an array into out, which must hold entry.value_count floats. Returns false if its checksum does not match.
+		*/
+		bool Read(const ArchiveEntry& entry, float* out) const noexcept;
+
+	private:
+		void Close() noexcept;
+
+		const uint8_t* base = nullptr;
+		size_t size = 0;
+		void* mapping = nullptr;
+		std::vector<ArchiveEntry> entries;
+	};
+
+	/** @brief The statistics and position of one column of a row group in a table.
+	* @note min and max ignore NaN. A chunk of NaN only has min set to +infinity and max set to -infinity.
+	*/
+	struct ColumnChunk
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint64_t nan_count;
+		float min;
+		float max;
+		uint32_t checksum;
+		Format codec;
+	};
+
+	/** @brief Selects the row groups where some value of a column may lie in [low, high].
+	*/
+	struct RangeFilter
+	{
+		uint32_t column;
+		float low;
+		float high;
+	};
+
+	/** @brief Writes a table: float columns split into row groups of a fixed number of rows, followed by the statistics of each chunk and a footer.
+	* @note Every column chunk is compressed on its own, with the format given for its column or with EncodeAuto.
+	*/
+	class TableWriter
+	{
+	public:
+		TableWriter() noexcept = default;
+		TableWriter(const TableWriter&) = delete;
+		TableWriter& operator=(const TableWriter&) = delete;
+
+		~TableWriter()
+		{
+			(void)Close();
+		}
+
+		/** @brief Creates or truncates the table at path. Returns false if the file cannot be opened.
+		* @param formats The format of each column, or null to let EncodeAuto pick one per chunk. A chunk that the format does not apply to falls back to EncodeAuto.
+		*/
+		bool Open(const char* path, const char* const* column_names, uint32_t column_count, size_t rows_per_group, const Format* formats = nullptr);
+
+		/** @brief Appends rows, given as one array of row_count values per column, and writes every row group that fills up. Returns false on I/O errors.
+		*/
+		bool Append(const float* const* columns, size_t row_count);
+
+		/** @brief Writes the last partial row group, the metadata and the footer, and closes the file. Returns false if any write failed.
+		*/
+		bool Close() noexcept;
+
+	private:
+		bool Flush();
+
+		std::FILE* file = nullptr;
+		uint64_t offset = 0;
+		uint64_t row_count = 0;
+		size_t rows_per_group = 0;
+		size_t pending_rows = 0;
+		uint32_t column_count = 0;
+		bool failed = false;
+		std::vector<Format> formats;
+		std::vector<uint8_t> names;
+		std::vector<uint8_t> chunks;
+		std::vector<float> pending;
+		std::vector<uint8_t> buffer;
+	};
+
+	/** @brief A read-only view of a table written by TableWriter.
+	* @note Open maps the file and parses the metadata. Chunks are decoded on demand, so a scan only touches the pages of the projected columns of the row groups it keeps.
+	*/
+	class Table
+	{
+	public:
+		Table() noexcept = default;
+
+		Table(Table&& other) noexcept :
+			base(std::exchange(other.base, nullptr)),
+			size(std::exchange(other.size, 0)),
+			mapping(std::exchange(other.mapping, nullptr)),
+			row_count(std::exchange(other.row_count, 0)),
+			rows_per_group(std::exchange(other.rows_per_group, 0)),
+			group_count(std::exchange(other.group_count, 0)),
+			column_count(std::exchange(other.column_count, 0)),
+			names(std::move(other.names)),
+			chunks(std::move(other.chunks))
+		{
+		}
+
+		Table& operator=(Table&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Close();
+				base = std::exchange(other.base, nullptr);
+				size = std::exchange(other.size, 0);
+				mapping = std::exchange(other.mapping, nullptr);
+				row_count = std::exchange(other.row_count, 0);
+				rows_per_group = std::exchange(other.rows_per_group, 0);
+				group_count = std::exchange(other.group_count, 0);
+				column_count = std::exchange(other.column_count, 0);
+				names = std::move(other.names);
+				chunks = std::move(other.chunks);
+			}
+			return *this;
+		}
+
+		Table(const Table&) = delete;
+		Table& operator=(const Table&) = delete;
+
+		~Table()
+		{
+			Close();
+		}
+
+		/** @brief Maps the table at path. The result converts to false if the file cannot be mapped or is not a valid table.
+		*/
+		static Table Open(const char* path);
+
+		explicit operator bool() const noexcept { return base != nullptr; }
+
+		uint32_t ColumnCount() const noexcept { return column_count; }
+		uint64_t RowCount() const noexcept { return row_count; }
+		uint64_t RowGroupCount() const noexcept { return group_count; }
+		const char* ColumnName(uint32_t column) const noexcept { return names[column]; }
+
+		/** @brief The number of rows of a row group. Only the last one may be shorter than the others.
+		*/
+		size_t GroupRowCount(uint64_t group) const noexcept
+		{
+			const uint64_t first = group * rows_per_group;
+			return (size_t)(row_count - first < rows_per_group ? row_count - first : rows_per_group);
+		}
+
+		const ColumnChunk& Chunk(uint64_t group, uint32_t column) const noexcept { return chunks[(size_t)group * column_count + column]; }
+
+		/** @brief Returns the index of the column called name, or ColumnCount() if there is none.
+		*/
+		uint32_t FindColumn(const char* name) const noexcept;
+
+		/** @brief Returns false if the statistics of the row group show that no row can pass every filter.
+		*/
+		bool MayMatch(uint64_t group, const RangeFilter* filters, size_t filter_count) const noexcept;
+
+		/** @brief Decompresses a column chunk into out, which must hold GroupRowCount(group) floats. Returns false if its checksum does not match.
+		*/
+		bool ReadChunk(uint64_t group, uint32_t column, float* out) const noexcept;
+
+		/** @brief Decodes the projected columns of every row group that may match the filters, spreading the row groups over threads.
+		* @param columns The indices of the projected columns, in the order they are passed to the callback.
+		* @param thread_count The number of threads, including the calling one. 0 uses one per hardware thread.
+		* @param callback Called as callback(group, first_row, row_count, values), where values[i] holds the rows of columns[i]. It runs concurrently on several threads, in no particular order.
+		* @return false if a checksum did not match. The scan then stops early.
+		* @note If callback throws, the scan stops and the exception is rethrown on the calling thread once every thread has finished.
+		* @note Filters only skip whole row groups: the rows of a kept group are passed on unfiltered.
+		*/
+		template <typename Callback>
+		bool Scan(const uint32_t* columns, size_t projected_count, const RangeFilter* filters, size_t filter_count, unsigned thread_count, Callback&& callback) const
+		{
+			std::atomic<uint64_t> next_group = { 0 };
+			std::atomic<bool> valid = { true };
+			if (thread_count == 0)
+				thread_count = std::thread::hardware_concurrency();
+			if (thread_count > group_count)
+				thread_count = (unsigned)group_count;
+			if (thread_count == 0)
+				thread_count = 1;
+			// Each thread decodes into its own slice. The buffers are allocated before any thread starts, so a bad_alloc reaches the caller.
+			// A size that overflows saturates, so that the vector throws instead of being allocated too small.
+			const size_t slice_size = rows_per_group <= SIZE_MAX / 4 / thread_count / (projected_count + 1) ? projected_count * (size_t)rows_per_group : SIZE_MAX / 4;
+			std::vector<float> values(slice_size <= SIZE_MAX / 4 / thread_count ? thread_count * slice_size : SIZE_MAX / 4);
+			std::vector<const float*> pointers(thread_count * projected_count);
+			const auto worker = [&](unsigned index)
+			{
+				float* const slice = values.data() + index * slice_size;
+				const float** const slice_pointers = pointers.data() + index * projected_count;
+				for (;;)
+				{
+					const uint64_t group = next_group.fetch_add(1, std::memory_order_relaxed);
+					if (group >= group_count || !valid.load(std::memory_order_relaxed))
+						return;
+					if (!MayMatch(group, filters, filter_count))
+						continue;
+					for (size_t i = 0; i != projected_count; ++i)
+					{
+						float* const out = slice + i * rows_per_group;
+						if (!ReadChunk(group, columns[i], out))
+						{
+							valid.store(false, std::memory_order_relaxed);
+							return;
+						}
+						slice_pointers[i] = out;
+					}
+					callback(group, group * rows_per_group, GroupRowCount(group), (const float* const*)slice_pointers);
+				}
+			};
+			std::exception_ptr error;
+			std::mutex error_mutex;
+			const auto guarded_worker = [&](unsigned index)
+			{
+				try
+				{
+					worker(index);
+				}
+				catch (...)
+				{
+					next_group.store(group_count, std::memory_order_relaxed);
+					std::lock_guard<std::mutex> lock(error_mutex);
+					if (!error)
+						error = std::current_exception();
+				}
+			};
+			// Joins the threads however the calling one leaves, destroying a joinable std::thread would call std::terminate.
+			struct Joiner
+			{
+				std::vector<std::thread>& threads;
+				std::atomic<uint64_t>& next_group;
+				uint64_t group_count;
+
+				~Joiner()
+				{
+					next_group.store(group_count, std::memory_order_relaxed);
+					for (auto& thread : threads)
+						thread.join();
+				}
+			};
+			std::vector<std::thread> threads;
+			{
+				Joiner joiner = { threads, next_group, group_count };
+				try
+				{
+					for (unsigned i = 1; i < thread_count; ++i)
+						threads.emplace_back(guarded_worker, i);
+				}
+				catch (...)
+				{
+					// Runs with the threads that could be started.
+				}
+				worker(0);
+			}
+			if (error)
+				std::rethrow_exception(error);
+			return valid.load();
+		}
+
+	private:
+		void Close() noexcept;
+
+		const uint8_t* base = nullptr;
+		size_t size = 0;
+		void* mapping = nullptr;
+		uint64_t row_count = 0;
+		uint64_t rows_per_group = 0;
+		uint64_t group_count = 0;
+		uint32_t column_count = 0;
+		std::vector<const char*> names;
+		std::vector<ColumnChunk> chunks;
+	};
+
+	/** @brief An append-only store for a stream of floats, kept as a list of segment files next to a manifest.
+	* @note Each Append encodes its batch with EncodeAuto and writes it as one record to the active log segment, opened with O_APPEND.
+	* Once the active segment reaches segment_bytes it is sealed and a new one starts. A background thread rewrites the sealed segments
+	* into a compacted segment of chunks of chunk_values values, with an index of the chunks at its end, then swaps the manifest.
+	* Files are named path.manifest, path.<id>.log and path.<id>.dat. Append must be called from one thread at a time; TakeSnapshot and
+	* Snapshot::Read may run concurrently with it and with compaction.
+	*/
+	class SegmentedLog
+	{
+		struct File;
+
+		struct Run
+		{
+			uint64_t first;
+			uint64_t offset;
+			uint64_t size;
+			uint32_t count;
+			uint32_t checksum;
+		};
+
+		// Immutable once published. Readers keep the file open, so a compacted segment stays readable after its file is removed.
+		struct Segment
+		{
+			uint64_t id = 0;
+			uint64_t first = 0;
+			uint64_t value_count = 0;
+			bool compacted = false;
+			std::shared_ptr<File> file;
+			std::vector<Run> runs;
+		};
+
+	public:
+		/** @brief A consistent view of the values appended before it was taken.
+		*/
+		class Snapshot
+		{
+		public:
+			uint64_t ValueCount() const noexcept { return value_count; }
+
+			/** @brief Decodes count values starting at index first into out. Returns false if the range is out of bounds, a read fails or a checksum does not match.
+			*/
+			bool Read(uint64_t first, size_t count, float* out) const;
+
+		private:
+			friend class SegmentedLog;
+
+			std::vector<std::shared_ptr<const Segment>> segments;
+			uint64_t value_count = 0;
+		};
+
+		SegmentedLog() noexcept = default;
+		SegmentedLog(const SegmentedLog&) = delete;
+		SegmentedLog& operator=(const SegmentedLog&) = delete;
+
+		~SegmentedLog()
+		{
+			(void)Close();
+		}
+
+		/** @brief Opens the log at path, loading the segments listed in its manifest, or creates an empty one. Returns false on I/O errors or if a segment is corrupt.
+		* @note A record torn by a crash ends its log segment. Appends always go to a new segment.
+		*/
+		bool Open(const char* path, size_t segment_bytes = 1 << 20, size_t chunk_values = 1 << 20, uint32_t compact_segments = 8);
+
+		/** @brief Appends values to the log. Returns false on I/O errors, after which the log refuses further appends.
+		*/
+		bool Append(const float* values, size_t value_count);
+
+		/** @brief Rewrites every sealed log segment into one compacted segment now, along with the last compacted segment if it holds less than a chunk.
+		* The background thread calls it once compact_segments segments are sealed.
+		*/
+		bool Compact();
+
+		/** @brief Blocks until fewer than compact_segments log segments are sealed, so the background thread has caught up with the appends so far.
+		* Returns false if a compaction fails or the log is closed first.
+		*/
+		bool WaitForCompaction();
+
+		/** @brief Returns a view of every value appended so far. It copies the run index of the active segment, which segment_bytes keeps small.
+		*/
+		Snapshot TakeSnapshot() const;
+
+		uint64_t ValueCount() const noexcept;
+		size_t SegmentCount() const noexcept;
+
+		/** @brief Stops the background thread and closes the active segment. Returns false if any append failed.
+		*/
+		bool Close() noexcept;
+
+	private:
+		static bool ReadRun(const File& file, const Run& run, std::vector<uint8_t>& compressed, float* out);
+		std::vector<char> SegmentPath(uint64_t id, bool compacted) const;
+		std::vector<char> ManifestPath(bool temporary) const;
+		std::shared_ptr<const Segment> LoadSegment(uint64_t id, bool compacted, uint64_t first) const;
+		bool WriteManifest(const std::vector<std::shared_ptr<const Segment>>& list) const;
+		bool Roll();
+		void CompactLoop();
+
+		mutable std::mutex mutex;
+		std::mutex compact_mutex;
+		std::condition_variable wake;
+		std::condition_variable caught_up;
+		std::thread compactor;
+		std::vector<char> prefix;
+		std::vector<std::shared_ptr<const Segment>> segments;
+		std::shared_ptr<File> active;
+		std::vector<Run> active_runs;
+		uint64_t active_id = 0;
+		uint64_t active_first = 0;
+		uint64_t active_bytes = 0;
+		uint64_t value_count = 0;
+		uint64_t next_id = 0;
+		size_t segment_bytes = 0;
+		size_t chunk_values = 0;
+		size_t sealed_count = 0;
+		uint32_t compact_segments = 0;
+		bool stopping = false;
+		bool failed = false;
+		bool compact_failed = false;
+		std::vector<uint8_t> buffer;
+	};
+
+	/** @brief The metadata of a frame published to a FrameRing.
+	*/
+	struct FrameInfo
+	{
+		uint64_t sequence;
+		uint64_t timestamp;
+		uint32_t value_count;
+		uint32_t compressed_size;
+		Format format;
+	};
+
+	enum class FrameStatus : uint8_t
+	{
+		Ready,
+		NotPublished,
+		Overwritten,
+	};
+
+	/** @brief A ring of compressed float frames in named shared memory, with one producer process and any number of consumer processes.
+	* @note Every consumer sees every frame: it keeps its own next sequence number and the producer never waits for it. A frame lives in slot
+	* sequence % slot_count until the producer wraps around, so a consumer that falls more than slot_count frames behind gets Overwritten and
+	* should resume from Oldest().
+	* @note Each slot is a seqlock. The producer encodes straight into the slot with Encode or EncodeQuick, and consumers decode straight from it,
+	* then check that the slot was not rewritten meanwhile. Consumers only map the ring read-only.
+	*/
+	class FrameRing
+	{
+		static constexpr uint32_t Magic = 0x31524356;
+		static constexpr size_t DecodePadding = 64;
+
+		// The magic number is stored last, so a consumer never sees a ring that is still being initialized.
+		struct alignas(64) Header
+		{
+			std::atomic<uint32_t> magic;
+			uint32_t slot_count;
+			uint64_t slot_stride;
+			uint64_t max_values;
+			alignas(64) std::atomic<uint64_t> head;
+		};
+
+		// The version is 2 * sequence + 1 while the frame is written and 2 * sequence + 2 once it is published.
+		struct alignas(64) Slot
+		{
+			std::atomic<uint64_t> version;
+			uint64_t timestamp;
+			uint32_t value_count;
+			uint32_t compressed_size;
+			Format format;
+		};
+
+		static_assert(std::atomic<uint64_t>::is_always_lock_free, "FrameRing needs address-free 64-bit atomics.");
+
+	public:
+		FrameRing() noexcept = default;
+
+		FrameRing(FrameRing&& other) noexcept :
+			base(std::exchange(other.base, nullptr)),
+			size(std::exchange(other.size, 0)),
+			mapping(std::exchange(other.mapping, nullptr))
+		{
+		}
+
+		FrameRing& operator=(FrameRing&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Close();
+				base = std::exchange(other.base, nullptr);
+				size = std::exchange(other.size, 0);
+				mapping = std::exchange(other.mapping, nullptr);
+			}
+			return *this;
+		}
+
+		FrameRing(const FrameRing&) = delete;
+		FrameRing& operator=(const FrameRing&) = delete;
+
+		~FrameRing()
+		{
+			Close();
+		}
+
+		/** @brief Creates the ring called name for the producer, replacing any previous one. Every frame holds at most max_values floats.
+		* The result converts to false if the shared memory cannot be created.
+		*/
+		static FrameRing Create(const char* name, uint32_t slot_count, size_t max_values);
+
+		/** @brief Maps an existing ring read-only for a consumer. The result converts to false if there is none.
+		*/
+		static FrameRing Attach(const char* name);
+
+		/** @brief Removes the name of a ring. Processes that mapped it keep their mapping. On Windows the ring goes away with its last handle instead.
+		*/
+		static bool Remove(const char* name) noexcept;
+
+		explicit operator bool() const noexcept { return base != nullptr; }
+
+		uint32_t SlotCount() const noexcept { return header()->slot_count; }
+		size_t MaxValues() const noexcept { return (size_t)header()->max_values; }
+
+		/** @brief The sequence number of the next frame to be published, that is the number of frames published so far.
+		*/
+		uint64_t Head() const noexcept { return header()->head.load(std::memory_order_acquire); }
+
+		/** @brief The sequence number of the oldest frame still in the ring.
+		*/
+		uint64_t Oldest() const noexcept
+		{
+			const uint64_t head = Head();
+			return head > header()->slot_count ? head - header()->slot_count : 0;
+		}
+
+		/** @brief Compresses a frame into the next slot and publishes it. Producer only.
+		* @param format Format::Default or Format::Quick.
+		*/
+		void Publish(const float* values, size_t value_count, uint64_t timestamp, Format format = Format::Quick) noexcept;
+
+		/** @brief Decodes frame sequence from its slot into out, which must hold MaxValues() floats. out only holds the frame if Ready is returned.
+		*/
+		FrameStatus Read(uint64_t sequence, float* out, FrameInfo& info) const noexcept;
+
+		/** @brief Gives visitor(info, compressed) direct access to the compressed bytes of frame sequence in shared memory, without copying them.
+		* @note The producer may rewrite the slot while the visitor runs. Whatever the visitor derived from the bytes is only valid if Ready is returned.
+		*/
+		template <typename Visitor>
+		FrameStatus Visit(uint64_t sequence, Visitor&& visitor) const
+		{
+			FrameInfo info;
+			const uint8_t* compressed;
+			const FrameStatus status = Begin(sequence, info, compressed);
+			if (status != FrameStatus::Ready)
+				return status;
+			visitor((const FrameInfo&)info, compressed);
+			return Validate(sequence) ? FrameStatus::Ready : FrameStatus::Overwritten;
+		}
+
+	private:
+		Header* header() const noexcept { return (Header*)base; }
+		Slot* slot(uint64_t sequence) const noexcept { return (Slot*)(base + sizeof(Header) + (size_t)(sequence % header()->slot_count * header()->slot_stride)); }
+
+		FrameStatus Begin(uint64_t sequence, FrameInfo& info, const uint8_t*& compressed) const noexcept;
+		bool Validate(uint64_t sequence) const noexcept;
+		void Close() noexcept;
+
+		uint8_t* base = nullptr;
+		size_t size = 0;
+		void* mapping = nullptr;
+	};
+}
+#endif
+
+
+
+#if defined(VECTOR_CODEC_IMPLEMENTATION) || defined(VECTOR_CODEC_INLINE)
+#include <utility>
+#include <cmath>
+#include <algorithm>
+#include <new>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <cerrno>
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#if defined(_DEBUG) || !defined(NDEBUG)
+#include <cassert>
+#define VECTOR_CODEC_INVARIANT assert
+#define VECTOR_CODEC_INLINE_ALWAYS
+#endif
+#if defined(__clang__) || defined(__GNUC__)
+#include <immintrin.h>
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (uint32_t)__builtin_bswap32((VALUE))
+#define VECTOR_CODEC_BSWAP16_IF_BE(VALUE) (uint16_t)__builtin_bswap16((VALUE))
+#else
+#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (VALUE)
+#define VECTOR_CODEC_BSWAP16_IF_BE(VALUE) (VALUE)
+#endif
+#ifndef VECTOR_CODEC_INLINE_ALWAYS
+#define VECTOR_CODEC_INLINE_ALWAYS __attribute__((flatten))
+#endif
+#define VECTOR_CODEC_UNLIKELY_IF(CONDITION) if (__builtin_expect((CONDITION), 0))
+#ifndef VECTOR_CODEC_INVARIANT
+#define VECTOR_CODEC_INVARIANT __builtin_assume
+#endif
+#define VECTOR_CODEC_CLZ __builtin_clz
+#define VECTOR_CODEC_POPCNT __builtin_popcount
+#define VECTOR_CODEC_CTZ __builtin_ctz
+#define VECTOR_CODEC_UNREACHABLE __builtin_unreachable()
+#else
+#include <intrin.h>
+#include <Windows.h>
+#if REG_DWORD == REG_DWORD_BIG_ENDIAN
+#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (uint32_t)_byteswap_ulong((VALUE))
+#define VECTOR_CODEC_BSWAP16_IF_BE(VALUE) (uint16_t)_byteswap_ushort((VALUE))
+#else
+#define VECTOR_CODEC_BSWAP_IF_BE(VALUE) (VALUE)
+#define VECTOR_CODEC_BSWAP16_IF_BE(VALUE) (VALUE)
+#endif
+#ifndef VECTOR_CODEC_INLINE_ALWAYS
+#define VECTOR_CODEC_INLINE_ALWAYS __forceinline
+#endif
+#define VECTOR_CODEC_UNLIKELY_IF(CONDITION) if ((CONDITION))
+#ifndef VECTOR_CODEC_INVARIANT
+#define VECTOR_CODEC_INVARIANT __assume
+#endif
+#define VECTOR_CODEC_CLZ __lzcnt
+#define VECTOR_CODEC_POPCNT __popcnt
+#define VECTOR_CODEC_CTZ _tzcnt_u32
+#define VECTOR_CODEC_UNREACHABLE __assume(0)
+#endif
+#ifdef __clang__
+#if __has_builtin(__builtin_memcpy)
+#define VECTOR_CODEC_MEMCPY (void)__builtin_memcpy
+#else
+#include <cstring>
+#define VECTOR_CODEC_MEMCPY (void)memcpy
+#endif
+#else
+#include <cstring>
+#define VECTOR_CODEC_MEMCPY (void)memcpy
+#endif
+#if defined(__AVX512VL__) && defined(__AVX512CD__) && defined(__AVX512BW__) && !defined(VECTOR_CODEC_DISABLE_AVX512VL)
+#define VECTOR_CODEC_AVX512VL
+#endif
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define VECTOR_CODEC_F16C
+#endif
+#if defined(__BMI2__) && !defined(VECTOR_CODEC_DISABLE_BMI2)
+#define VECTOR_CODEC_BMI2
+#if defined(__clang__) || defined(__GNUC__)
+#include <cpuid.h>
+#endif
+#endif
+
+namespace VectorCodec
+{
+	namespace Impl
+	{
+		constexpr uint32_t LookupSize = 128;
+		constexpr size_t UnrollLimit = 16;
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i VectorHash_AVX2(__m256i v, __m256i i) noexcept
+		{
+			v = _mm256_srli_epi32(v, 24);
+			v = _mm256_and_si256(v, _mm256_set1_epi32(LookupSize - 1));
+			return v;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t PackHeader_AVX2(__m256i lzcounts, __m256i tzcounts) noexcept
+		{
+			lzcounts = _mm256_sllv_epi32(lzcounts, _mm256_set_epi32(14, 12, 10, 8, 6, 4, 2, 0));
+			tzcounts = _mm256_sllv_epi32(tzcounts, _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16));
+			lzcounts = _mm256_or_si256(lzcounts, tzcounts);
+			lzcounts = _mm256_or_si256(lzcounts, _mm256_srli_si256(lzcounts, 8));
+			lzcounts = _mm256_or_si256(lzcounts, _mm256_srli_epi64(lzcounts, 32));
+			return (uint32_t)_mm256_extract_epi32(lzcounts, 0) | (uint32_t)_mm256_extract_epi32(lzcounts, 4);
+		}
+
+		// Moves the 7-bit fields of packed selected by mask next to each other, and back.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint64_t CompressIndices_AVX2(uint64_t packed, uint32_t mask) noexcept
+		{
+			uint64_t r = 0;
+			for (uint32_t shift = 0; mask != 0; mask &= mask - 1, shift += 7)
+				r |= ((packed >> (VECTOR_CODEC_CTZ(mask) * 7)) & 127) << shift;
+			return r;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint64_t ExpandIndices_AVX2(uint64_t compressed, uint32_t mask) noexcept
+		{
+			uint64_t r = 0;
+			for (; mask != 0; mask &= mask - 1, compressed >>= 7)
+				r |= (compressed & 127) << (VECTOR_CODEC_CTZ(mask) * 7);
+			return r;
+		}
+
+		struct ISA_AVX2
+		{
+			VECTOR_CODEC_INLINE_ALWAYS static
+			void StoreLookup(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i indices, __m256i vec) noexcept
+			{
+				lookup[_mm256_extract_epi32(indices, 0)] = _mm256_extract_epi32(vec, 0);
+				lookup[_mm256_extract_epi32(indices, 1)] = _mm256_extract_epi32(vec, 1);
+				lookup[_mm256_extract_epi32(indices, 2)] = _mm256_extract_epi32(vec, 2);
+				lookup[_mm256_extract_epi32(indices, 3)] = _mm256_extract_epi32(vec, 3);
+				lookup[_mm256_extract_epi32(indices, 4)] = _mm256_extract_epi32(vec, 4);
+				lookup[_mm256_extract_epi32(indices, 5)] = _mm256_extract_epi32(vec, 5);
+				lookup[_mm256_extract_epi32(indices, 6)] = _mm256_extract_epi32(vec, 6);
+				lookup[_mm256_extract_epi32(indices, 7)] = _mm256_extract_epi32(vec, 7);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint64_t CompressIndices(uint64_t packed, uint32_t mask) noexcept
+			{
+				return CompressIndices_AVX2(packed, mask);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint64_t ExpandIndices(uint64_t compressed, uint32_t mask) noexcept
+			{
+				return ExpandIndices_AVX2(compressed, mask);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			void StoreResidual(__m256i vec, uint8_t* VECTOR_CODEC_RESTRICT& out, __m256i& lzcounts, __m256i& tzcounts) noexcept
+			{
+				__m256i tmp = _mm256_andnot_si256(_mm256_sub_epi32(vec, _mm256_set1_epi32(1)), vec);
+				tzcounts = _mm256_set1_epi32(32);
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(tmp, _mm256_setzero_si256()), _mm256_set1_epi32(1)));
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x0000ffff)), _mm256_setzero_si256()), _mm256_set1_epi32(16)));
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x00ff00ff)), _mm256_setzero_si256()), _mm256_set1_epi32(8)));
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x0f0f0f0f)), _mm256_setzero_si256()), _mm256_set1_epi32(4)));
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x33333333)), _mm256_setzero_si256()), _mm256_set1_epi32(2)));
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(tmp, _mm256_set1_epi32(0x55555555)), _mm256_setzero_si256()), _mm256_set1_epi32(1)));
+				tzcounts = _mm256_srli_epi32(tzcounts, 3);
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_srli_epi32(tzcounts, 2));
+				vec = _mm256_srlv_epi32(vec, _mm256_slli_epi32(tzcounts, 3));
+				lzcounts = _mm256_srli_epi32(_mm256_set_epi32(
+					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 7)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 6)),
+					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 5)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 4)),
+					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 3)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 2)),
+					VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 1)), VECTOR_CODEC_CLZ(_mm256_extract_epi32(vec, 0))), 3);
+				tmp = _mm256_sub_epi32(_mm256_set1_epi32(4), _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpeq_epi32(lzcounts, _mm256_set1_epi32(3)))));
+				lzcounts = _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpgt_epi32(lzcounts, _mm256_set1_epi32(2))));
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 0)); out += _mm256_extract_epi32(tmp, 0);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 1)); out += _mm256_extract_epi32(tmp, 1);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 2)); out += _mm256_extract_epi32(tmp, 2);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 3)); out += _mm256_extract_epi32(tmp, 3);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 4)); out += _mm256_extract_epi32(tmp, 4);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 5)); out += _mm256_extract_epi32(tmp, 5);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 6)); out += _mm256_extract_epi32(tmp, 6);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 7)); out += _mm256_extract_epi32(tmp, 7);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint32_t EncodeResidual(__m256i vec, uint8_t* VECTOR_CODEC_RESTRICT& out) noexcept
+			{
+				__m256i lzcounts, tzcounts;
+				StoreResidual(vec, out, lzcounts, tzcounts);
+				return PackHeader_AVX2(lzcounts, tzcounts);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			__m256i DecodeResidual(uint32_t header, const uint8_t* VECTOR_CODEC_RESTRICT& data) noexcept
+			{
+				__m256i tmp = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(14, 10, 6, 2, 12, 8, 4, 0)), _mm256_set1_epi32(3));
+				__m128i lzcounts = _mm_or_si128(_mm256_extracti128_si256(tmp, 0), _mm256_extracti128_si256(_mm256_slli_epi32(tmp, 16), 1));
+				__m128i prefix_sum = lzcounts = _mm_sub_epi16(_mm_set1_epi16(4), _mm_add_epi16(lzcounts, _mm_srli_epi16(_mm_add_epi16(lzcounts, _mm_set1_epi16(1)), 2)));
+				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 2), prefix_sum);
+				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 4), prefix_sum);
+				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 8), prefix_sum);
+				__m256i vec = _mm256_i32gather_epi32((const int*)data, _mm256_cvtepi16_epi32(_mm_slli_si128(prefix_sum, 2)), 1);
+				data += _mm_extract_epi16(prefix_sum, 7);
+				vec = _mm256_and_si256(vec, _mm256_sub_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_slli_epi32(_mm256_cvtepi16_epi32(lzcounts), 3)), _mm256_set1_epi32(1)));
+				tmp = _mm256_slli_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16)), _mm256_set1_epi32(3)), 3);
+				return _mm256_sllv_epi32(vec, tmp);
+			}
+		};
+
+#ifdef VECTOR_CODEC_BMI2
+		// Interleaves the low and high bits of each 2-bit code, taken from the sign masks of the lanes.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t PackHeader_BMI2(__m256i lzcounts, __m256i tzcounts) noexcept
+		{
+			uint32_t lo = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(lzcounts, 31)));
+			uint32_t hi = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(lzcounts, 30)));
+			lo |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(tzcounts, 31))) << 8;
+			hi |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(tzcounts, 30))) << 8;
+			return _pdep_u32(lo, 0x55555555) | _pdep_u32(hi, 0xaaaaaaaa);
+		}
+
+		// Spreads the 2-bit codes to one byte each, then computes the byte sizes and their prefix sums in a general purpose register.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i DecodeResidual_BMI2(uint32_t header, const uint8_t* VECTOR_CODEC_RESTRICT& data) noexcept
+		{
+			uint64_t lzcodes = _pdep_u64(header, 0x0303030303030303);
+			uint64_t tzcodes = _pdep_u64(header >> 16, 0x0303030303030303);
+			uint64_t sizes = 0x0404040404040404 - lzcodes - (((lzcodes + 0x0101010101010101) >> 2) & 0x0101010101010101);
+			uint64_t offsets = sizes * 0x0101010101010101;
+			__m256i vec = _mm256_i32gather_epi32((const int*)data, _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)(offsets << 8))), 1);
+			data += offsets >> 56;
+			vec = _mm256_and_si256(vec, _mm256_sub_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)(sizes << 3)))), _mm256_set1_epi32(1)));
+			return _mm256_sllv_epi32(vec, _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)(tzcodes << 3))));
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint64_t CompressIndices_BMI2(uint64_t packed, uint32_t mask) noexcept
+		{
+			return _pext_u64(packed, _pdep_u64(mask, 0x0102040810204081) * 127);
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint64_t ExpandIndices_BMI2(uint64_t compressed, uint32_t mask) noexcept
+		{
+			return _pdep_u64(compressed, _pdep_u64(mask, 0x0102040810204081) * 127);
+		}
+
+		struct ISA_BMI2 : ISA_AVX2
+		{
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint64_t CompressIndices(uint64_t packed, uint32_t mask) noexcept
+			{
+				return CompressIndices_BMI2(packed, mask);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint64_t ExpandIndices(uint64_t compressed, uint32_t mask) noexcept
+			{
+				return ExpandIndices_BMI2(compressed, mask);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint32_t EncodeResidual(__m256i vec, uint8_t* VECTOR_CODEC_RESTRICT& out) noexcept
+			{
+				__m256i lzcounts, tzcounts;
+				StoreResidual(vec, out, lzcounts, tzcounts);
+				return PackHeader_BMI2(lzcounts, tzcounts);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			__m256i DecodeResidual(uint32_t header, const uint8_t* VECTOR_CODEC_RESTRICT& data) noexcept
+			{
+				return DecodeResidual_BMI2(header, data);
+			}
+		};
+
+#ifndef VECTOR_CODEC_AVX512VL
+		// PDEP and PEXT are microcoded on AMD processors before Zen 3, where they are slower than the AVX2 shifts.
+		// Dispatch only asks when it falls back to BMI2, which it never does with AVX-512VL.
+		static bool DetectFastPDEP() noexcept
+		{
+			uint32_t regs[4] = {};
+#if defined(__clang__) || defined(__GNUC__)
+			__cpuid(0, regs[0], regs[1], regs[2], regs[3]);
+#else
+			__cpuid((int*)regs, 0);
+#endif
+			const bool amd = regs[1] == 0x68747541 && regs[3] == 0x69746e65 && regs[2] == 0x444d4163; // "AuthenticAMD"
+			const bool hygon = regs[1] == 0x6f677948 && regs[3] == 0x6e65476e && regs[2] == 0x656e6975; // "HygonGenuine"
+			if (!amd && !hygon)
+				return true;
+#if defined(__clang__) || defined(__GNUC__)
+			__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#else
+			__cpuid((int*)regs, 1);
+#endif
+			uint32_t family = (regs[0] >> 8) & 15;
+			if (family == 15)
+				family += (regs[0] >> 20) & 255;
+			return family >= 0x19;
+		}
+
+		static bool HasFastPDEP() noexcept
+		{
+			static const bool r = DetectFastPDEP();
+			return r;
+		}
+#endif
+#endif
+
+#ifdef VECTOR_CODEC_AVX512VL
+		// Same bitstream as ISA_AVX2, but keeps every step in ymm registers using the AVX-512VL/CD/BW extensions.
+		struct ISA_AVX512VL
+		{
+			VECTOR_CODEC_INLINE_ALWAYS static
+			void StoreLookup(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i indices, __m256i vec) noexcept
+			{
+				// Scatters are ordered from the lowest to the highest lane, so colliding indices resolve like the scalar stores.
+				_mm256_i32scatter_epi32(lookup, indices, vec, 4);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint64_t CompressIndices(uint64_t packed, uint32_t mask) noexcept
+			{
+#ifdef VECTOR_CODEC_BMI2
+				return CompressIndices_BMI2(packed, mask);
+#else
+				return CompressIndices_AVX2(packed, mask);
+#endif
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint64_t ExpandIndices(uint64_t compressed, uint32_t mask) noexcept
+			{
+#ifdef VECTOR_CODEC_BMI2
+				return ExpandIndices_BMI2(compressed, mask);
+#else
+				return ExpandIndices_AVX2(compressed, mask);
+#endif
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			__mmask32 PayloadMask(__m256i sizes) noexcept
+			{
+				sizes = _mm256_shuffle_epi8(sizes, _mm256_set_epi8(
+					12, 12, 12, 12, 8, 8, 8, 8, 4, 4, 4, 4, 0, 0, 0, 0,
+					12, 12, 12, 12, 8, 8, 8, 8, 4, 4, 4, 4, 0, 0, 0, 0));
+				return _mm256_cmplt_epu8_mask(_mm256_set1_epi32(0x03020100), sizes);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			uint32_t EncodeResidual(__m256i vec, uint8_t* VECTOR_CODEC_RESTRICT& out) noexcept
+			{
+				__m256i tzcounts = _mm256_sub_epi32(_mm256_set1_epi32(32), _mm256_lzcnt_epi32(_mm256_andnot_si256(vec, _mm256_sub_epi32(vec, _mm256_set1_epi32(1)))));
+				tzcounts = _mm256_srli_epi32(tzcounts, 3);
+				tzcounts = _mm256_sub_epi32(tzcounts, _mm256_srli_epi32(tzcounts, 2));
+				vec = _mm256_srlv_epi32(vec, _mm256_slli_epi32(tzcounts, 3));
+				__m256i lzcounts = _mm256_srli_epi32(_mm256_lzcnt_epi32(vec), 3);
+				__m256i sizes = _mm256_sub_epi32(_mm256_set1_epi32(4), _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpeq_epi32(lzcounts, _mm256_set1_epi32(3)))));
+				lzcounts = _mm256_sub_epi32(lzcounts, _mm256_and_si256(_mm256_set1_epi32(1), _mm256_cmpgt_epi32(lzcounts, _mm256_set1_epi32(2))));
+#ifdef __AVX512VBMI2__
+				__mmask32 mask = PayloadMask(sizes);
+				_mm256_storeu_si256((__m256i*)out, _mm256_maskz_compress_epi8(mask, vec));
+				out += _mm_popcnt_u32(_cvtmask32_u32(mask));
+#else
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 0)); out += _mm256_extract_epi32(sizes, 0);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 1)); out += _mm256_extract_epi32(sizes, 1);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 2)); out += _mm256_extract_epi32(sizes, 2);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 3)); out += _mm256_extract_epi32(sizes, 3);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 4)); out += _mm256_extract_epi32(sizes, 4);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 5)); out += _mm256_extract_epi32(sizes, 5);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 6)); out += _mm256_extract_epi32(sizes, 6);
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(_mm256_extract_epi32(vec, 7)); out += _mm256_extract_epi32(sizes, 7);
+#endif
+#ifdef VECTOR_CODEC_BMI2
+				return PackHeader_BMI2(lzcounts, tzcounts);
+#else
+				return PackHeader_AVX2(lzcounts, tzcounts);
+#endif
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS static
+			__m256i DecodeResidual(uint32_t header, const uint8_t* VECTOR_CODEC_RESTRICT& data) noexcept
+			{
+#ifdef __AVX512VBMI2__
+				__m256i codes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(14, 12, 10, 8, 6, 4, 2, 0)), _mm256_set1_epi32(3));
+				__mmask32 mask = PayloadMask(_mm256_sub_epi32(_mm256_set1_epi32(4), _mm256_add_epi32(codes, _mm256_srli_epi32(_mm256_add_epi32(codes, _mm256_set1_epi32(1)), 2))));
+				__m256i vec = _mm256_maskz_expandloadu_epi8(mask, data);
+				data += _mm_popcnt_u32(_cvtmask32_u32(mask));
+				codes = _mm256_slli_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16)), _mm256_set1_epi32(3)), 3);
+				return _mm256_sllv_epi32(vec, codes);
+#elif defined(VECTOR_CODEC_BMI2)
+				return DecodeResidual_BMI2(header, data);
+#else
+				return ISA_AVX2::DecodeResidual(header, data);
+#endif
+			}
+		};
+
+#endif
+
+		// Every AVX-512 capable processor has a fast PDEP, so the runtime check is only needed for the AVX2 tier.
+		template <typename F>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		auto Dispatch(F&& f) noexcept
+		{
+#if defined(VECTOR_CODEC_AVX512VL)
+			return f(ISA_AVX512VL());
+#elif defined(VECTOR_CODEC_BMI2)
+			if (HasFastPDEP())
+				return f(ISA_BMI2());
+			return f(ISA_AVX2());
+#else
+			return f(ISA_AVX2());
+#endif
+		}
+
+		// Invokes f(i) for every i in [0, Count), fully unrolled when Count is small.
+		template <size_t Count, typename F, size_t... I>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void ForEachBlock(F&& f, std::index_sequence<I...>) noexcept
+		{
+			(f(I), ...);
+		}
+
+		template <size_t Count, typename F>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void ForEachBlock(F&& f) noexcept
+		{
+			if constexpr (Count <= UnrollLimit)
+			{
+				ForEachBlock<Count>(f, std::make_index_sequence<Count>());
+			}
+			else
+			{
+				for (size_t i = 0; i != Count; ++i)
+					f(i);
+			}
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t EncodeBlock_AVX2(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i& indices, __m256i& predicted, __m256i vec, uint8_t* VECTOR_CODEC_RESTRICT& out) noexcept
+		{
+			ISA::StoreLookup(lookup, indices, vec);
+			indices = VectorHash_AVX2(vec, indices);
+			vec = _mm256_xor_si256(vec, predicted);
+			predicted = _mm256_i32gather_epi32(lookup, indices, 4);
+			return ISA::EncodeResidual(vec, out);
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		size_t Encode_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(64) int32_t lookup[LookupSize] = {};
+			const float* const end = values + value_count;
+			const uint8_t* const out_begin = out;
+			__m256i indices, predicted;
+			uint32_t* out_headers = (uint32_t*)out;
+			indices = predicted = _mm256_setzero_si256();
+			out += ((value_count + 7) & ~7) / 2;
+			do
+			{
+				__m256i vec = _mm256_setzero_si256();
+				size_t n = (end - values);
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)values);
+				*out_headers = VECTOR_CODEC_BSWAP_IF_BE(EncodeBlock_AVX2<ISA>(lookup, indices, predicted, vec, out));
+				++out_headers;
+#ifdef VECTOR_CODEC_EARLY_EXIT
+				VECTOR_CODEC_UNLIKELY_IF(out - out_begin > value_count * 4)
+					return 0;
+#endif
+				values += 8;
+			} while (values < end);
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i PredictBlock_AVX2(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i& indices, __m256i& predicted, __m256i residual) noexcept
+		{
+			__m256i vec = _mm256_xor_si256(residual, predicted);
+			ISA::StoreLookup(lookup, indices, vec);
+			indices = VectorHash_AVX2(vec, indices);
+			predicted = _mm256_i32gather_epi32(lookup, indices, 4);
+			return vec;
+		}
+
+		struct DecodeState_AVX2
+		{
+			alignas(32) int32_t lookup[LookupSize];
+			__m256i indices, predicted;
+			const uint32_t* in_headers;
+			const uint8_t* data;
+			float* out;
+			size_t value_count;
+		};
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeInit_AVX2(DecodeState_AVX2& state, const uint8_t* data, size_t value_count, float* out) noexcept
+		{
+			for (int32_t& e : state.lookup)
+				e = 0;
+			state.indices = state.predicted = _mm256_setzero_si256();
+			state.in_headers = (const uint32_t*)data;
+			state.data = data + ((value_count + 7) & ~7) / 2;
+			state.out = out;
+			state.value_count = value_count;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static __m256i DecodeBlock_AVX2(DecodeState_AVX2& state) noexcept
+		{
+			uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*state.in_headers);
+			++state.in_headers;
+			return PredictBlock_AVX2<ISA>(state.lookup, state.indices, state.predicted, ISA::DecodeResidual(header, state.data));
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeFinish_AVX2(DecodeState_AVX2& state) noexcept
+		{
+			while (state.value_count >= 8)
+			{
+				_mm256_storeu_si256((__m256i*)state.out, DecodeBlock_AVX2<ISA>(state));
+				state.value_count -= 8;
+				state.out += 8;
+			}
+			VECTOR_CODEC_UNLIKELY_IF(state.value_count != 0)
+			{
+				__m256i vec = DecodeBlock_AVX2<ISA>(state);
+				VECTOR_CODEC_MEMCPY(state.out, &vec, state.value_count << 2);
+				state.value_count = 0;
+			}
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void Decode_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			DecodeState_AVX2 state;
+			DecodeInit_AVX2(state, data, value_count, out);
+			DecodeFinish_AVX2<ISA>(state);
+			_mm256_zeroall();
+		}
+
+		// Runs K independent decoders in lockstep so that their lookup/gather dependency chains overlap.
+		template <typename ISA, size_t K>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeInterleaved_AVX2(const uint8_t* const* data, const size_t* value_counts, float* const* out) noexcept
+		{
+			DecodeState_AVX2 states[K];
+			size_t rounds = SIZE_MAX;
+			for (size_t i = 0; i != K; ++i)
+			{
+				DecodeInit_AVX2(states[i], data[i], value_counts[i], out[i]);
+				if (rounds > value_counts[i] / 8)
+					rounds = value_counts[i] / 8;
+			}
+			for (; rounds != 0; --rounds)
+			{
+				for (size_t i = 0; i != K; ++i)
+				{
+					_mm256_storeu_si256((__m256i*)states[i].out, DecodeBlock_AVX2<ISA>(states[i]));
+					states[i].value_count -= 8;
+					states[i].out += 8;
+				}
+			}
+			for (size_t i = 0; i != K; ++i)
+				DecodeFinish_AVX2<ISA>(states[i]);
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeMany_AVX2(const uint8_t* const* data, const size_t* value_counts, float* const* out, size_t stream_count) noexcept
+		{
+			for (; stream_count >= 4; stream_count -= 4, data += 4, value_counts += 4, out += 4)
+				DecodeInterleaved_AVX2<ISA, 4>(data, value_counts, out);
+			switch (stream_count)
+			{
+			case 3:
+				DecodeInterleaved_AVX2<ISA, 3>(data, value_counts, out);
+				break;
+			case 2:
+				DecodeInterleaved_AVX2<ISA, 2>(data, value_counts, out);
+				break;
+			case 1:
+				DecodeInterleaved_AVX2<ISA, 1>(data, value_counts, out);
+				break;
+			default:
+				break;
+			}
+			_mm256_zeroall();
+		}
+
+		template <typename ISA, size_t N>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeFixed_AVX2(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			static_assert(N != 0, "VectorCodec: N must be greater than zero.");
+			alignas(64) int32_t lookup[LookupSize] = {};
+			const uint8_t* const out_begin = out;
+			__m256i indices, predicted;
+			uint32_t* out_headers = (uint32_t*)out;
+			indices = predicted = _mm256_setzero_si256();
+			out += ((N + 7) & ~(size_t)7) / 2;
+			ForEachBlock<N / 8>([&](size_t i)
+			{
+				__m256i vec = _mm256_loadu_si256((const __m256i*)(values + i * 8));
+				out_headers[i] = VECTOR_CODEC_BSWAP_IF_BE(EncodeBlock_AVX2<ISA>(lookup, indices, predicted, vec, out));
+			});
+			if constexpr (N % 8 != 0)
+			{
+				__m256i vec = _mm256_setzero_si256();
+				VECTOR_CODEC_MEMCPY(&vec, values + (N & ~(size_t)7), (N % 8) * 4);
+				out_headers[N / 8] = VECTOR_CODEC_BSWAP_IF_BE(EncodeBlock_AVX2<ISA>(lookup, indices, predicted, vec, out));
+			}
+			_mm256_zeroall();
+			return out - out_begin;
+		}
+
+		template <typename ISA, size_t N>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeFixed_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			static_assert(N != 0, "VectorCodec: N must be greater than zero.");
+			DecodeState_AVX2 state;
+			DecodeInit_AVX2(state, data, N, out);
+			ForEachBlock<N / 8>([&](size_t i)
+			{
+				_mm256_storeu_si256((__m256i*)(out + i * 8), DecodeBlock_AVX2<ISA>(state));
+			});
+			if constexpr (N % 8 != 0)
+			{
+				__m256i vec = DecodeBlock_AVX2<ISA>(state);
+				VECTOR_CODEC_MEMCPY(out + (N & ~(size_t)7), &vec, (N % 8) * 4);
+			}
+			_mm256_zeroall();
+		}
+
+		// Number of payload bytes described by the lz half of a block header.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t PayloadSize(uint32_t lzcodes) noexcept
+		{
+			return 32 - VECTOR_CODEC_POPCNT(lzcodes) - VECTOR_CODEC_POPCNT(lzcodes & 0xaaaa) - VECTOR_CODEC_POPCNT(lzcodes & (lzcodes >> 1) & 0x5555);
+		}
+
+		// Layout: the lz halves of all headers (2 bytes per block), one flag bit per block, then the payload.
+		// Blocks whose flag is set store the tz half of their header right after their payload bytes.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void EncodeCompactBlock_AVX2(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i& indices, __m256i& predicted, __m256i vec, uint16_t* VECTOR_CODEC_RESTRICT out_headers, uint8_t* VECTOR_CODEC_RESTRICT out_flags, size_t i, uint8_t* VECTOR_CODEC_RESTRICT& out) noexcept
+		{
+			uint32_t header = EncodeBlock_AVX2<ISA>(lookup, indices, predicted, vec, out);
+			uint32_t flag = (header >> 16) != 0;
+			out_headers[i] = VECTOR_CODEC_BSWAP16_IF_BE((uint16_t)header);
+			*(uint16_t*)out = VECTOR_CODEC_BSWAP16_IF_BE((uint16_t)(header >> 16));
+			out += flag << 1;
+			out_flags[i >> 3] |= (uint8_t)(flag << (i & 7));
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i DecodeCompactBlock_AVX2(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i& indices, __m256i& predicted, const uint16_t* VECTOR_CODEC_RESTRICT in_headers, const uint8_t* VECTOR_CODEC_RESTRICT in_flags, size_t i, const uint8_t* VECTOR_CODEC_RESTRICT& data) noexcept
+		{
+			uint32_t header = VECTOR_CODEC_BSWAP16_IF_BE(in_headers[i]);
+			uint32_t flag = (in_flags[i >> 3] >> (i & 7)) & 1;
+			header |= ((uint32_t)VECTOR_CODEC_BSWAP16_IF_BE(*(const uint16_t*)(data + PayloadSize(header))) & (0U - flag)) << 16;
+			__m256i vec = PredictBlock_AVX2<ISA>(lookup, indices, predicted, ISA::DecodeResidual(header, data));
+			data += flag << 1;
+			return vec;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeCompact_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(64) int32_t lookup[LookupSize] = {};
+			const float* const end = values + value_count;
+			const uint8_t* const out_begin = out;
+			const size_t block_count = (value_count + 7) / 8;
+			__m256i indices, predicted;
+			uint16_t* out_headers = (uint16_t*)out;
+			uint8_t* out_flags = out + block_count * 2;
+			indices = predicted = _mm256_setzero_si256();
+			out = out_flags + (block_count + 7) / 8;
+			for (uint8_t* flags = out_flags; flags != out; ++flags)
+				*flags = 0;
+			for (size_t i = 0; values < end; ++i)
+			{
+				__m256i vec = _mm256_setzero_si256();
+				size_t n = (end - values);
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)values);
+				EncodeCompactBlock_AVX2<ISA>(lookup, indices, predicted, vec, out_headers, out_flags, i, out);
+#ifdef VECTOR_CODEC_EARLY_EXIT
+				VECTOR_CODEC_UNLIKELY_IF(out - out_begin > value_count * 4)
+					return 0;
+#endif
+				values += 8;
+			}
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeCompact_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(32) int32_t lookup[LookupSize] = {};
+			const size_t block_count = (value_count + 7) / 8;
+			const uint16_t* in_headers = (const uint16_t*)data;
+			const uint8_t* in_flags = data + block_count * 2;
+			__m256i indices, predicted;
+			indices = predicted = _mm256_setzero_si256();
+			data = in_flags + (block_count + 7) / 8;
+			for (size_t i = 0; i != block_count; ++i)
+			{
+				__m256i vec = DecodeCompactBlock_AVX2<ISA>(lookup, indices, predicted, in_headers, in_flags, i, data);
+				VECTOR_CODEC_UNLIKELY_IF(value_count < 8)
+				{
+					VECTOR_CODEC_MEMCPY(out, &vec, value_count << 2);
+					break;
+				}
+				_mm256_storeu_si256((__m256i*)out, vec);
+				value_count -= 8;
+				out += 8;
+			}
+			_mm256_zeroall();
+		}
+
+		constexpr uint32_t ChimpWindow = 128;
+		constexpr uint32_t ChimpIndexBits = 13;
+
+		// Packs eight 7-bit reference indices into the low 56 bits of the result.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint64_t PackChimpIndices_AVX2(__m256i indices) noexcept
+		{
+			indices = _mm256_sllv_epi32(indices, _mm256_set_epi32(21, 14, 7, 0, 21, 14, 7, 0));
+			indices = _mm256_or_si256(indices, _mm256_srli_si256(indices, 8));
+			indices = _mm256_or_si256(indices, _mm256_srli_epi64(indices, 32));
+			return (uint64_t)(uint32_t)_mm256_extract_epi32(indices, 0) | ((uint64_t)(uint32_t)_mm256_extract_epi32(indices, 4) << 28);
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i UnpackChimpIndices_AVX2(uint64_t packed) noexcept
+		{
+			__m256i indices = _mm256_set_m128i(_mm_set1_epi32((int)(packed >> 28)), _mm_set1_epi32((int)packed));
+			indices = _mm256_srlv_epi32(indices, _mm256_set_epi32(21, 14, 7, 0, 21, 14, 7, 0));
+			return _mm256_and_si256(indices, _mm256_set1_epi32(ChimpWindow - 1));
+		}
+
+		// Number of zero bytes in each lane, a cheap estimate of how well a residual packs.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i ZeroBytes_AVX2(__m256i vec) noexcept
+		{
+			vec = _mm256_and_si256(_mm256_cmpeq_epi8(vec, _mm256_setzero_si256()), _mm256_set1_epi8(1));
+			return _mm256_madd_epi16(_mm256_maddubs_epi16(vec, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+		}
+
+		// Chimp128: a value is XORed with the previous value, or with one of the 128 values before its block when that is more effective.
+		// The window candidate is the most recent value that shares the low ChimpIndexBits bits. Layout: one 32-bit header per block, then
+		// for each block a byte with the lanes that use a window reference, their 7-bit ring indices packed into as few bytes as possible,
+		// and the payload.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t EncodeChimpBlock_AVX2(int32_t* VECTOR_CODEC_RESTRICT ring, int32_t* VECTOR_CODEC_RESTRICT positions, __m256i& position, __m256i vec, uint8_t* VECTOR_CODEC_RESTRICT& out) noexcept
+		{
+			const uint32_t first = (uint32_t)_mm256_cvtsi256_si32(position);
+			__m256i previous = _mm256_permutevar8x32_epi32(vec, _mm256_set_epi32(6, 5, 4, 3, 2, 1, 0, 0));
+			previous = _mm256_blend_epi32(previous, _mm256_set1_epi32(ring[(first - 1) & (ChimpWindow - 1)]), 1);
+			previous = _mm256_xor_si256(vec, previous);
+			__m256i keys = _mm256_and_si256(vec, _mm256_set1_epi32((1U << ChimpIndexBits) - 1));
+			__m256i candidates = _mm256_i32gather_epi32(positions, keys, 4);
+			__m256i use = _mm256_cmpgt_epi32(candidates, _mm256_set1_epi32((int32_t)(first - ChimpWindow - 1)));
+			__m256i indices = _mm256_and_si256(candidates, _mm256_set1_epi32(ChimpWindow - 1));
+			__m256i residual = _mm256_xor_si256(vec, _mm256_i32gather_epi32(ring, indices, 4));
+			use = _mm256_and_si256(use, _mm256_cmpgt_epi32(ZeroBytes_AVX2(residual), ZeroBytes_AVX2(previous)));
+			residual = _mm256_blendv_epi8(previous, residual, use);
+			const uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(use));
+			*out = (uint8_t)mask;
+			++out;
+			*(uint64_t*)out = ISA::CompressIndices(PackChimpIndices_AVX2(indices), mask);
+			out += (VECTOR_CODEC_POPCNT(mask) * 7 + 7) / 8;
+			const uint32_t header = ISA::EncodeResidual(residual, out);
+			_mm256_store_si256((__m256i*)(ring + (first & (ChimpWindow - 1))), vec);
+			ISA::StoreLookup(positions, keys, position);
+			position = _mm256_add_epi32(position, _mm256_set1_epi32(8));
+			return header;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeChimp_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(64) int32_t ring[ChimpWindow] = {};
+			alignas(64) int32_t positions[1U << ChimpIndexBits] = {};
+			const float* const end = values + value_count;
+			const uint8_t* const out_begin = out;
+			uint32_t* out_headers = (uint32_t*)out;
+			__m256i position = _mm256_set_epi32(ChimpWindow + 7, ChimpWindow + 6, ChimpWindow + 5, ChimpWindow + 4, ChimpWindow + 3, ChimpWindow + 2, ChimpWindow + 1, ChimpWindow);
+			out += ((value_count + 7) & ~7) / 2;
+			while (values < end)
+			{
+				__m256i vec = _mm256_setzero_si256();
+				size_t n = (end - values);
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)values);
+				*out_headers = VECTOR_CODEC_BSWAP_IF_BE(EncodeChimpBlock_AVX2<ISA>(ring, positions, position, vec, out));
+				++out_headers;
+#ifdef VECTOR_CODEC_EARLY_EXIT
+				VECTOR_CODEC_UNLIKELY_IF(out - out_begin > value_count * 4)
+					return 0;
+#endif
+				values += 8;
+			}
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i DecodeChimpBlock_AVX2(int32_t* VECTOR_CODEC_RESTRICT ring, uint32_t& position, uint32_t header, const uint8_t* VECTOR_CODEC_RESTRICT& data) noexcept
+		{
+			const uint32_t mask = *data;
+			++data;
+			__m256i indices = UnpackChimpIndices_AVX2(ISA::ExpandIndices(*(const uint64_t*)data, mask));
+			data += (VECTOR_CODEC_POPCNT(mask) * 7 + 7) / 8;
+			__m256i use = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1)), _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1));
+			__m256i vec = ISA::DecodeResidual(header, data);
+			vec = _mm256_xor_si256(vec, _mm256_and_si256(_mm256_i32gather_epi32(ring, indices, 4), use));
+			// Lanes that refer to the previous value form runs that are resolved with a segmented prefix XOR.
+			__m256i first = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, -1);
+			vec = _mm256_xor_si256(vec, _mm256_and_si256(_mm256_andnot_si256(use, first), _mm256_set1_epi32(ring[(position - 1) & (ChimpWindow - 1)])));
+			use = _mm256_or_si256(use, first);
+			vec = _mm256_xor_si256(vec, _mm256_andnot_si256(use, _mm256_permutevar8x32_epi32(vec, _mm256_set_epi32(6, 5, 4, 3, 2, 1, 0, 0))));
+			use = _mm256_or_si256(use, _mm256_permutevar8x32_epi32(use, _mm256_set_epi32(6, 5, 4, 3, 2, 1, 0, 0)));
+			vec = _mm256_xor_si256(vec, _mm256_andnot_si256(use, _mm256_permutevar8x32_epi32(vec, _mm256_set_epi32(5, 4, 3, 2, 1, 0, 0, 0))));
+			use = _mm256_or_si256(use, _mm256_permutevar8x32_epi32(use, _mm256_set_epi32(5, 4, 3, 2, 1, 0, 0, 0)));
+			vec = _mm256_xor_si256(vec, _mm256_andnot_si256(use, _mm256_permutevar8x32_epi32(vec, _mm256_set_epi32(3, 2, 1, 0, 0, 0, 0, 0))));
+			_mm256_store_si256((__m256i*)(ring + position), vec);
+			position = (position + 8) & (ChimpWindow - 1);
+			return vec;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeChimp_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(64) int32_t ring[ChimpWindow] = {};
+			const uint32_t* in_headers = (const uint32_t*)data;
+			uint32_t position = 0;
+			data += ((value_count + 7) & ~7) / 2;
+			while (value_count != 0)
+			{
+				uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*in_headers);
+				++in_headers;
+				__m256i vec = DecodeChimpBlock_AVX2<ISA>(ring, position, header, data);
+				VECTOR_CODEC_UNLIKELY_IF(value_count < 8)
+				{
+					VECTOR_CODEC_MEMCPY(out, &vec, value_count << 2);
+					break;
+				}
+				_mm256_storeu_si256((__m256i*)out, vec);
+				value_count -= 8;
+				out += 8;
+			}
+			_mm256_zeroall();
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeQuick_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const float* const end = values + value_count;
+			const uint8_t* const out_begin = out;
+			__m256i prior;
+			uint32_t* out_headers = (uint32_t*)out;
+			prior = _mm256_setzero_si256();
+			out += ((value_count + 7) & ~7) / 2;
+			do
+			{
+				__m256i vec = _mm256_setzero_si256();
+				size_t n = (end - values);
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)values);
+				__m256i tmp = vec;
+				vec = _mm256_sub_epi32(vec, prior);
+				prior = tmp;
+				*out_headers = VECTOR_CODEC_BSWAP_IF_BE(ISA::EncodeResidual(vec, out));
+				++out_headers;
+#ifdef VECTOR_CODEC_EARLY_EXIT
+				VECTOR_CODEC_UNLIKELY_IF(out - out_begin > value_count * 4)
+					return 0;
+#endif
+				values += 8;
+			} while (values < end);
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeQuick_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint32_t* in_headers = (const uint32_t*)data;
 			__m256i prior = _mm256_setzero_si256();
 			data += ((value_count + 7) & ~7) / 2;
 			while (true)
 			{
-				uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*in_headers);
-				++in_headers;
-				__m256i tmp = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(14, 10, 6, 2, 12, 8, 4, 0)), _mm256_set1_epi32(3));
-				__m128i lzcounts = _mm_or_si128(_mm256_extracti128_si256(tmp, 0), _mm256_extracti128_si256(_mm256_slli_epi32(tmp, 16), 1));
-				__m128i prefix_sum = lzcounts = _mm_sub_epi16(_mm_set1_epi16(4), _mm_add_epi16(lzcounts, _mm_srli_epi16(_mm_add_epi16(lzcounts, _mm_set1_epi16(1)), 2)));
-				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 2), prefix_sum);
-				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 4), prefix_sum);
-				prefix_sum = _mm_add_epi16(_mm_slli_si128(prefix_sum, 8), prefix_sum);
-				__m256i vec = _mm256_i32gather_epi32((const int*)data, _mm256_cvtepi16_epi32(_mm_slli_si128(prefix_sum, 2)), 1);
-				data += _mm_extract_epi16(prefix_sum, 7);
-				vec = _mm256_and_si256(vec, _mm256_sub_epi32(_mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_slli_epi32(_mm256_cvtepi16_epi32(lzcounts), 3)), _mm256_set1_epi32(1)));
-				tmp = _mm256_slli_epi32(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(header), _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16)), _mm256_set1_epi32(3)), 3);
-				vec = _mm256_sllv_epi32(vec, tmp);
-				vec = _mm256_add_epi32(vec, prior);
-				VECTOR_CODEC_UNLIKELY_IF(value_count < 8)
+				uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*in_headers);
+				++in_headers;
+				__m256i vec = _mm256_add_epi32(ISA::DecodeResidual(header, data), prior);
+				VECTOR_CODEC_UNLIKELY_IF(value_count < 8)
+				{
+					VECTOR_CODEC_UNLIKELY_IF(value_count != 0)
+						VECTOR_CODEC_MEMCPY(out, &vec, value_count << 2);
+					_mm256_zeroall();
+					return;
+				}
+				_mm256_storeu_si256((__m256i*)out, vec);
+				prior = vec;
+				value_count -= 8;
+				out += 8;
+			}
+		}
+
+		constexpr size_t ALPBlockSize = 1024;
+		constexpr size_t ALPSampleSize = 32;
+		constexpr uint32_t ALPMaxExponent = 10;
+		constexpr uint32_t ALPRawBlock = 15;
+
+		// Every power of ten up to 10^10 is exact as a float, the inverse powers are rounded. Decoding divides by the exact power so that
+		// digits / 10^e is correctly rounded, as it is when the value was parsed from text.
+		constexpr float ALPPowers[ALPMaxExponent + 1] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+		constexpr float ALPInversePowers[ALPMaxExponent + 1] = { 1e0f, 1e-1f, 1e-2f, 1e-3f, 1e-4f, 1e-5f, 1e-6f, 1e-7f, 1e-8f, 1e-9f, 1e-10f };
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256 ALPDecodeVector_AVX2(__m256i digits, __m256 factor, __m256 exponent) noexcept
+		{
+			return _mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(digits), factor), exponent);
+		}
+
+		// Maps values to integers for one exponent/factor pair. Lanes that do not survive the round trip bit for bit are cleared in ok.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i ALPEncodeVector_AVX2(__m256 vec, __m256 exponent, __m256 inverse_factor, __m256 factor, __m256i& ok) noexcept
+		{
+			__m256i digits = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_mul_ps(vec, exponent), inverse_factor));
+			ok = _mm256_cmpeq_epi32(_mm256_castps_si256(ALPDecodeVector_AVX2(digits, factor, exponent)), _mm256_castps_si256(vec));
+			return digits;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		int32_t HorizontalMin_AVX2(__m256i vec) noexcept
+		{
+			__m128i half = _mm_min_epi32(_mm256_castsi256_si128(vec), _mm256_extracti128_si256(vec, 1));
+			half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+			half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(half);
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		int32_t HorizontalMax_AVX2(__m256i vec) noexcept
+		{
+			__m128i half = _mm_max_epi32(_mm256_castsi256_si128(vec), _mm256_extracti128_si256(vec, 1));
+			half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+			half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(half);
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t BitWidth(uint32_t range) noexcept
+		{
+			return range != 0 ? 32 - VECTOR_CODEC_CLZ(range) : 0;
+		}
+
+		// Estimates the cost of every exponent/factor pair on a sample of the block and returns the cheapest, packed as exponent | factor << 4.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t ALPChoose_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+		{
+			alignas(32) float sample[ALPSampleSize];
+			const size_t step = value_count >= ALPSampleSize ? value_count / ALPSampleSize : 1;
+			for (size_t i = 0; i != ALPSampleSize; ++i)
+				sample[i] = values[i * step < value_count ? i * step : 0];
+			uint32_t best = 0;
+			uint32_t best_cost = UINT32_MAX;
+			for (uint32_t exponent = 0; exponent <= ALPMaxExponent; ++exponent)
+			{
+				for (uint32_t factor = 0; factor <= exponent; ++factor)
+				{
+					const __m256 e = _mm256_set1_ps(ALPPowers[exponent]);
+					const __m256 inverse_f = _mm256_set1_ps(ALPInversePowers[factor]);
+					const __m256 f = _mm256_set1_ps(ALPPowers[factor]);
+					__m256i low = _mm256_set1_epi32(INT32_MAX);
+					__m256i high = _mm256_set1_epi32(INT32_MIN);
+					uint32_t exceptions = 0;
+					for (size_t i = 0; i != ALPSampleSize; i += 8)
+					{
+						__m256i ok;
+						__m256i digits = ALPEncodeVector_AVX2(_mm256_load_ps(sample + i), e, inverse_f, f, ok);
+						exceptions += 8 - VECTOR_CODEC_POPCNT((uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(ok)));
+						low = _mm256_min_epi32(low, _mm256_blendv_epi8(_mm256_set1_epi32(INT32_MAX), digits, ok));
+						high = _mm256_max_epi32(high, _mm256_blendv_epi8(_mm256_set1_epi32(INT32_MIN), digits, ok));
+					}
+					VECTOR_CODEC_UNLIKELY_IF(exceptions == ALPSampleSize)
+						continue;
+					const uint32_t cost = BitWidth((uint32_t)HorizontalMax_AVX2(high) - (uint32_t)HorizontalMin_AVX2(low)) * ALPSampleSize + exceptions * 48;
+					if (cost < best_cost)
+					{
+						best_cost = cost;
+						best = exponent | factor << 4;
+					}
+				}
+			}
+			return best;
+		}
+
+		// Block layout: a 32-bit header holding the exponent, the factor, the bit width and the number of exceptions, the 32-bit frame of
+		// reference, the bit-packed integers, the 16-bit exception positions and the exception values. Raw blocks only have the header.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint8_t* EncodeALPBlock_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(32) int32_t digits[ALPBlockSize];
+			uint16_t positions[ALPBlockSize];
+			const uint32_t choice = ALPChoose_AVX2(values, value_count);
+			const uint32_t exponent = choice & 15;
+			const uint32_t factor = choice >> 4;
+			const __m256 e = _mm256_set1_ps(ALPPowers[exponent]);
+			const __m256 inverse_f = _mm256_set1_ps(ALPInversePowers[factor]);
+			const __m256 f = _mm256_set1_ps(ALPPowers[factor]);
+			__m256i low = _mm256_set1_epi32(INT32_MAX);
+			__m256i high = _mm256_set1_epi32(INT32_MIN);
+			size_t exception_count = 0;
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				__m256 vec = _mm256_setzero_ps();
+				size_t n = value_count - i;
+				uint32_t valid = 0xFF;
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+				{
+					VECTOR_CODEC_MEMCPY(&vec, values + i, n << 2);
+					valid = (1U << n) - 1;
+				}
+				else
+					vec = _mm256_loadu_ps(values + i);
+				__m256i ok;
+				__m256i d = ALPEncodeVector_AVX2(vec, e, inverse_f, f, ok);
+				_mm256_store_si256((__m256i*)(digits + i), d);
+				const uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(ok));
+				for (uint32_t failed = ~mask & valid; failed != 0; failed &= failed - 1)
+					positions[exception_count++] = (uint16_t)(i + VECTOR_CODEC_CTZ(failed));
+				ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(_mm256_set1_epi32((int32_t)n), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0)));
+				low = _mm256_min_epi32(low, _mm256_blendv_epi8(_mm256_set1_epi32(INT32_MAX), d, ok));
+				high = _mm256_max_epi32(high, _mm256_blendv_epi8(_mm256_set1_epi32(INT32_MIN), d, ok));
+			}
+			const int32_t base = HorizontalMin_AVX2(low);
+			const uint32_t width = BitWidth((uint32_t)HorizontalMax_AVX2(high) - (uint32_t)base);
+			const size_t groups = (value_count + 7) / 8;
+			uint32_t* header = (uint32_t*)out;
+			out += 8;
+			VECTOR_CODEC_UNLIKELY_IF(exception_count == value_count || groups * width + exception_count * 6 >= value_count * 4)
+			{
+				header[0] = VECTOR_CODEC_BSWAP_IF_BE(ALPRawBlock);
+				header[1] = 0;
+				VECTOR_CODEC_MEMCPY(out, values, value_count << 2);
+				return out + (value_count << 2);
+			}
+			header[0] = VECTOR_CODEC_BSWAP_IF_BE((uint32_t)(choice | width << 8 | exception_count << 16));
+			header[1] = VECTOR_CODEC_BSWAP_IF_BE((uint32_t)base);
+			for (size_t i = 0; i != exception_count; ++i)
+				digits[positions[i]] = base;
+			for (size_t i = value_count; i != groups * 8; ++i)
+				digits[i] = base;
+			uint64_t bits = 0;
+			uint32_t bit_count = 0;
+			for (size_t i = 0; i != groups * 8; ++i)
+			{
+				bits |= (uint64_t)((uint32_t)digits[i] - (uint32_t)base) << bit_count;
+				bit_count += width;
+				if (bit_count >= 32)
+				{
+					*(uint32_t*)out = (uint32_t)bits;
+					out += 4;
+					bits >>= 32;
+					bit_count -= 32;
+				}
+			}
+			for (; bit_count != 0; bit_count -= 8)
+			{
+				*out = (uint8_t)bits;
+				++out;
+				bits >>= 8;
+			}
+			VECTOR_CODEC_MEMCPY(out, positions, exception_count * 2);
+			out += exception_count * 2;
+			for (size_t i = 0; i != exception_count; ++i)
+			{
+				VECTOR_CODEC_MEMCPY(out, values + positions[i], 4);
+				out += 4;
+			}
+			return out;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		const uint8_t* DecodeALPBlock_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(((const uint32_t*)data)[0]);
+			const __m256i base = _mm256_set1_epi32((int32_t)VECTOR_CODEC_BSWAP_IF_BE(((const uint32_t*)data)[1]));
+			const uint32_t exponent = header & 15;
+			data += 8;
+			VECTOR_CODEC_UNLIKELY_IF(exponent == ALPRawBlock)
+			{
+				VECTOR_CODEC_MEMCPY(out, data, value_count << 2);
+				return data + (value_count << 2);
+			}
+			const uint32_t width = (header >> 8) & 63;
+			const size_t exception_count = header >> 16;
+			const __m256 f = _mm256_set1_ps(ALPPowers[(header >> 4) & 15]);
+			const __m256 e = _mm256_set1_ps(ALPPowers[exponent]);
+			const size_t groups = (value_count + 7) / 8;
+			if (width <= 25)
+			{
+				// Eight values take exactly width bytes, so each group starts on a byte boundary and is unpacked with two
+				// 16-byte loads, a byte shuffle and a variable shift.
+				alignas(32) int8_t shuffle[32];
+				alignas(32) int32_t shifts[8];
+				const uint32_t middle = (width * 4) >> 3;
+				for (uint32_t i = 0; i != 8; ++i)
+				{
+					const uint32_t bit = i * width;
+					const uint32_t byte = (bit >> 3) - (i < 4 ? 0 : middle);
+					for (uint32_t j = 0; j != 4; ++j)
+						shuffle[i * 4 + j] = (int8_t)(byte + j);
+					shifts[i] = (int32_t)(bit & 7);
+				}
+				const __m256i shuffle_mask = _mm256_load_si256((const __m256i*)shuffle);
+				const __m256i shift = _mm256_load_si256((const __m256i*)shifts);
+				const __m256i mask = _mm256_set1_epi32((int32_t)((1U << width) - 1));
+				for (size_t i = 0; i != groups; ++i)
+				{
+					const uint8_t* group = data + i * width;
+					__m256i vec = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)group)), _mm_loadu_si128((const __m128i*)(group + middle)), 1);
+					vec = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(vec, shuffle_mask), shift), mask);
+					__m256 values = ALPDecodeVector_AVX2(_mm256_add_epi32(vec, base), f, e);
+					VECTOR_CODEC_UNLIKELY_IF(i * 8 + 8 > value_count)
+						VECTOR_CODEC_MEMCPY(out + i * 8, &values, (value_count - i * 8) << 2);
+					else
+						_mm256_storeu_ps(out + i * 8, values);
+				}
+			}
+			else
+			{
+				alignas(32) uint32_t digits[8];
+				const uint64_t mask = (1ULL << width) - 1;
+				for (size_t i = 0; i != groups; ++i)
+				{
+					for (uint32_t j = 0; j != 8; ++j)
+					{
+						const size_t bit = (i * 8 + j) * width;
+						uint64_t word;
+						VECTOR_CODEC_MEMCPY(&word, data + (bit >> 3), 8);
+						digits[j] = (uint32_t)((word >> (bit & 7)) & mask);
+					}
+					__m256 values = ALPDecodeVector_AVX2(_mm256_add_epi32(_mm256_load_si256((const __m256i*)digits), base), f, e);
+					VECTOR_CODEC_UNLIKELY_IF(i * 8 + 8 > value_count)
+						VECTOR_CODEC_MEMCPY(out + i * 8, &values, (value_count - i * 8) << 2);
+					else
+						_mm256_storeu_ps(out + i * 8, values);
+				}
+			}
+			data += groups * width;
+			const uint8_t* exceptions = data + exception_count * 2;
+			for (size_t i = 0; i != exception_count; ++i)
+			{
+				uint16_t position;
+				VECTOR_CODEC_MEMCPY(&position, data + i * 2, 2);
+				VECTOR_CODEC_MEMCPY(out + position, exceptions + i * 4, 4);
+			}
+			return exceptions + exception_count * 4;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeALP_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint8_t* const out_begin = out;
+			for (size_t i = 0; i < value_count; i += ALPBlockSize)
+				out = EncodeALPBlock_AVX2(values + i, value_count - i < ALPBlockSize ? value_count - i : ALPBlockSize, out);
+			// The decoder reads up to 16 bytes past the last packed group.
+			_mm_storeu_si128((__m128i*)out, _mm_setzero_si128());
+			out += 16;
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeALP_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			for (size_t i = 0; i < value_count; i += ALPBlockSize)
+				data = DecodeALPBlock_AVX2(data, value_count - i < ALPBlockSize ? value_count - i : ALPBlockSize, out + i);
+			_mm256_zeroall();
+		}
+
+		constexpr uint32_t DictionaryCapacity = 256;
+		constexpr uint32_t DictionaryHashBits = 10;
+
+		// Open addressing table with linear probing. Slot codes are biased by one so that 0 marks an empty slot.
+		struct DictionaryTable
+		{
+			alignas(64) int32_t keys[1U << DictionaryHashBits];
+			alignas(64) int32_t codes[1U << DictionaryHashBits];
+			alignas(64) int32_t values[DictionaryCapacity];
+			uint32_t count;
+		};
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i DictionaryHash_AVX2(__m256i vec) noexcept
+		{
+			return _mm256_srli_epi32(_mm256_mullo_epi32(vec, _mm256_set1_epi32((int32_t)0x9E3779B1U)), 32 - DictionaryHashBits);
+		}
+
+		// Returns the code of each lane found in its home slot, or -1.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i DictionaryFind_AVX2(const DictionaryTable& table, __m256i vec, __m256i hash) noexcept
+		{
+			__m256i codes = _mm256_i32gather_epi32(table.codes, hash, 4);
+			__m256i hit = _mm256_cmpeq_epi32(_mm256_i32gather_epi32(table.keys, hash, 4), vec);
+			hit = _mm256_andnot_si256(_mm256_cmpeq_epi32(codes, _mm256_setzero_si256()), hit);
+			return _mm256_blendv_epi8(_mm256_set1_epi32(-1), _mm256_sub_epi32(codes, _mm256_set1_epi32(1)), hit);
+		}
+
+		// Looks up a key past its home slot, adding it when missing. Returns -1 when the table is full.
+		static int32_t DictionaryInsert(DictionaryTable& table, int32_t key, uint32_t hash) noexcept
+		{
+			for (;; hash = (hash + 1) & ((1U << DictionaryHashBits) - 1))
+			{
+				if (table.codes[hash] == 0)
+				{
+					VECTOR_CODEC_UNLIKELY_IF(table.count == DictionaryCapacity)
+						return -1;
+					table.keys[hash] = key;
+					table.values[table.count] = key;
+					++table.count;
+					table.codes[hash] = (int32_t)table.count;
+					return (int32_t)table.count - 1;
+				}
+				if (table.keys[hash] == key)
+					return table.codes[hash] - 1;
+			}
+		}
+
+		// Loads up to 8 values. Missing lanes repeat the first value so that they never add a dictionary entry.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i DictionaryLoad_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t n) noexcept
+		{
+			VECTOR_CODEC_UNLIKELY_IF(n < 8)
+			{
+				int32_t first;
+				VECTOR_CODEC_MEMCPY(&first, values, 4);
+				__m256i vec = _mm256_set1_epi32(first);
+				VECTOR_CODEC_MEMCPY(&vec, values, n << 2);
+				return vec;
+			}
+			return _mm256_loadu_si256((const __m256i*)values);
+		}
+
+		// Maps 8 values to their codes, inserting the ones that are missing. Returns false when the table overflows.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		bool DictionaryCodes_AVX2(DictionaryTable& table, __m256i vec, __m256i& codes) noexcept
+		{
+			__m256i hash = DictionaryHash_AVX2(vec);
+			codes = DictionaryFind_AVX2(table, vec, hash);
+			uint32_t missing = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(codes));
+			VECTOR_CODEC_UNLIKELY_IF(missing != 0)
+			{
+				alignas(32) int32_t keys[8];
+				alignas(32) int32_t hashes[8];
+				alignas(32) int32_t found[8];
+				_mm256_store_si256((__m256i*)keys, vec);
+				_mm256_store_si256((__m256i*)hashes, hash);
+				_mm256_store_si256((__m256i*)found, codes);
+				for (; missing != 0; missing &= missing - 1)
+				{
+					const uint32_t i = VECTOR_CODEC_CTZ(missing);
+					found[i] = DictionaryInsert(table, keys[i], (uint32_t)hashes[i]);
+					VECTOR_CODEC_UNLIKELY_IF(found[i] < 0)
+						return false;
+				}
+				codes = _mm256_load_si256((const __m256i*)found);
+			}
+			return true;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		bool DictionaryBuild_AVX2(DictionaryTable& table, const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+		{
+			for (size_t i = 0; i != (1U << DictionaryHashBits); i += 8)
+				_mm256_store_si256((__m256i*)(table.codes + i), _mm256_setzero_si256());
+			table.count = 0;
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				__m256i codes;
+				VECTOR_CODEC_UNLIKELY_IF(!DictionaryCodes_AVX2(table, DictionaryLoad_AVX2(values + i, value_count - i), codes))
+					return false;
+			}
+			return true;
+		}
+
+		// Layout: the number of entries, the entries, then each group of 8 indices packed into width bytes. The decoder reads 8 bytes per
+		// group, hence the trailing padding.
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeDictionary_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			DictionaryTable table;
+			VECTOR_CODEC_UNLIKELY_IF(value_count == 0 || !DictionaryBuild_AVX2(table, values, value_count))
+				return 0;
+			const uint8_t* const out_begin = out;
+			const uint32_t width = BitWidth(table.count - 1);
+			*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE(table.count);
+			VECTOR_CODEC_MEMCPY(out + 4, table.values, table.count * 4);
+			out += 4 + table.count * 4;
+			const uint64_t lanes = 0x0101010101010101ULL * ((1U << width) - 1);
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				__m256i codes;
+				(void)DictionaryCodes_AVX2(table, DictionaryLoad_AVX2(values + i, value_count - i), codes);
+				__m128i bytes = _mm_packus_epi16(_mm_packus_epi32(_mm256_castsi256_si128(codes), _mm256_extracti128_si256(codes, 1)), _mm_setzero_si128());
+				uint64_t code_bytes = (uint64_t)_mm_cvtsi128_si64(bytes) & lanes;
+				uint64_t packed = 0;
+				for (uint32_t j = 0; j != 8; ++j)
+					packed |= ((code_bytes >> (j * 8)) & 0xFF) << (j * width);
+				VECTOR_CODEC_MEMCPY(out, &packed, 8);
+				out += width;
+			}
+			*(uint64_t*)out = 0;
+			out += 8;
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		// Decodes value_count values from the packed groups at data, returning the first group that was not read.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		const uint8_t* DecodeDictionaryGroups_AVX2(const float* VECTOR_CODEC_RESTRICT dictionary, uint32_t count, const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint32_t width = BitWidth(count - 1);
+			alignas(32) int8_t shuffle[32];
+			alignas(32) int32_t shifts[8];
+			for (uint32_t i = 0; i != 8; ++i)
+			{
+				const uint32_t bit = i * width;
+				shuffle[i * 4] = (int8_t)(bit >> 3);
+				shuffle[i * 4 + 1] = (int8_t)((bit >> 3) + 1);
+				shuffle[i * 4 + 2] = -128;
+				shuffle[i * 4 + 3] = -128;
+				shifts[i] = (int32_t)(bit & 7);
+			}
+			const __m256i shuffle_mask = _mm256_load_si256((const __m256i*)shuffle);
+			const __m256i shift = _mm256_load_si256((const __m256i*)shifts);
+			const __m256i mask = _mm256_set1_epi32((int32_t)((1U << width) - 1));
+			// Up to 16 entries live in registers, larger dictionaries are read with a gather.
+			__m256 low = _mm256_setzero_ps();
+			__m256 high = _mm256_setzero_ps();
+			VECTOR_CODEC_MEMCPY(&low, dictionary, (count < 8 ? count : 8) * 4);
+			if (count > 8 && count <= 16)
+				VECTOR_CODEC_MEMCPY(&high, dictionary + 8, (count - 8) * 4);
+			while (true)
+			{
+				int64_t packed;
+				VECTOR_CODEC_MEMCPY(&packed, data, 8);
+				data += width;
+				__m256i indices = _mm256_shuffle_epi8(_mm256_set1_epi64x(packed), shuffle_mask);
+				indices = _mm256_and_si256(_mm256_srlv_epi32(indices, shift), mask);
+				__m256 vec;
+				if (count <= 8)
+					vec = _mm256_permutevar8x32_ps(low, indices);
+				else if (count <= 16)
+					vec = _mm256_blendv_ps(_mm256_permutevar8x32_ps(low, indices), _mm256_permutevar8x32_ps(high, indices), _mm256_castsi256_ps(_mm256_slli_epi32(indices, 28)));
+				else
+					vec = _mm256_i32gather_ps(dictionary, indices, 4);
+				VECTOR_CODEC_UNLIKELY_IF(value_count <= 8)
+				{
+					VECTOR_CODEC_MEMCPY(out, &vec, value_count << 2);
+					return data;
+				}
+				_mm256_storeu_ps(out, vec);
+				value_count -= 8;
+				out += 8;
+			}
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeDictionary_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			VECTOR_CODEC_UNLIKELY_IF(value_count == 0)
+				return;
+			const uint32_t count = VECTOR_CODEC_BSWAP_IF_BE(*(const uint32_t*)data);
+			(void)DecodeDictionaryGroups_AVX2((const float*)(data + 4), count, data + 4 + count * 4, value_count, out);
+			_mm256_zeroall();
+		}
+
+		constexpr size_t RLEMinRun = 3;
+		constexpr uint32_t RLELiteral = 0x80000000U;
+		constexpr size_t RLEMaxLength = RLELiteral - 1;
+
+		// A literal segment is a 32-bit length with RLELiteral set followed by the values, a run is a 32-bit length followed by the value.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint8_t* EmitRLELiteral(const float* VECTOR_CODEC_RESTRICT values, size_t length, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			while (length != 0)
+			{
+				const size_t n = length < RLEMaxLength ? length : RLEMaxLength;
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE((uint32_t)n | RLELiteral);
+				VECTOR_CODEC_MEMCPY(out + 4, values, n << 2);
+				out += 4 + (n << 2);
+				values += n;
+				length -= n;
+			}
+			return out;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint8_t* EmitRLERun(const float* VECTOR_CODEC_RESTRICT value, size_t length, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			while (length != 0)
+			{
+				const size_t n = length < RLEMaxLength ? length : RLEMaxLength;
+				*(uint32_t*)out = VECTOR_CODEC_BSWAP_IF_BE((uint32_t)n);
+				VECTOR_CODEC_MEMCPY(out + 4, value, 4);
+				out += 8;
+				length -= n;
+			}
+			return out;
+		}
+
+		// Run boundaries are found 8 at a time by comparing the values with their successors, so long runs cost one compare per 8 values.
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeRLE_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint8_t* const out_begin = out;
+			size_t literal = 0;
+			size_t run = 0;
+			auto boundary = [&](size_t last)
+			{
+				if (last + 1 - run >= RLEMinRun)
+				{
+					out = EmitRLELiteral(values + literal, run - literal, out);
+					out = EmitRLERun(values + run, last + 1 - run, out);
+					literal = last + 1;
+				}
+				run = last + 1;
+			};
+			size_t i = 0;
+			for (; i + 8 < value_count; i += 8)
+			{
+				__m256i vec = _mm256_loadu_si256((const __m256i*)(values + i));
+				__m256i next = _mm256_loadu_si256((const __m256i*)(values + i + 1));
+				uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(vec, next))) ^ 0xFF;
+				for (; mask != 0; mask &= mask - 1)
+					boundary(i + VECTOR_CODEC_CTZ(mask));
+			}
+			for (; i + 1 < value_count; ++i)
+				if (((const uint32_t*)values)[i] != ((const uint32_t*)values)[i + 1])
+					boundary(i);
+			VECTOR_CODEC_UNLIKELY_IF(value_count != 0)
+				boundary(value_count - 1);
+			out = EmitRLELiteral(values + literal, value_count - literal, out);
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		// Runs are written with broadcast stores that may spill past the run, the following runs overwrite the excess.
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeRLE_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			float* const end = out + value_count;
+			while (out != end)
+			{
+				const uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*(const uint32_t*)data);
+				const size_t length = header & ~RLELiteral;
+				data += 4;
+				if (header & RLELiteral)
+				{
+					VECTOR_CODEC_MEMCPY(out, data, length << 2);
+					data += length << 2;
+					out += length;
+					continue;
+				}
+				const __m256 vec = _mm256_set1_ps(*(const float*)data);
+				data += 4;
+				float* const run_end = out + length;
+				if ((size_t)(end - run_end) >= 8)
+				{
+					for (float* p = out; p < run_end; p += 8)
+						_mm256_storeu_ps(p, vec);
+				}
+				else
+				{
+					float* p = out;
+					for (; p + 8 <= run_end; p += 8)
+						_mm256_storeu_ps(p, vec);
+					VECTOR_CODEC_MEMCPY(p, &vec, (run_end - p) << 2);
+				}
+				out = run_end;
+			}
+			_mm256_zeroall();
+		}
+
+		constexpr size_t DowncastBlockSize = 1024;
+
+		enum DowncastType : uint8_t
+		{
+			DowncastFloat32,
+			DowncastInt8,
+			DowncastInt16,
+			DowncastFloat16,
+			DowncastBFloat16,
+		};
+
+		constexpr size_t DowncastWidths[] = { 4, 1, 2, 2, 2 };
+
+		// The conversion used without F16C. It is always defined so that it can be checked against the instruction; unlike the
+		// instruction, it keeps signaling NaNs signaling.
+		[[maybe_unused]] VECTOR_CODEC_INLINE_ALWAYS static
+		__m256 HalfToFloatFallback_AVX2(__m128i half) noexcept
+		{
+			// Rebiases the exponent, then fixes up infinities, NaNs and denormals.
+			const __m256i h = _mm256_cvtepu16_epi32(half);
+			__m256i o = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0x7FFF)), 13);
+			const __m256i exponent = _mm256_and_si256(o, _mm256_set1_epi32(0x0F800000));
+			o = _mm256_add_epi32(o, _mm256_set1_epi32(0x38000000));
+			o = _mm256_add_epi32(o, _mm256_and_si256(_mm256_cmpeq_epi32(exponent, _mm256_set1_epi32(0x0F800000)), _mm256_set1_epi32(0x38000000)));
+			__m256 denormal = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_add_epi32(o, _mm256_set1_epi32(0x00800000))), _mm256_castsi256_ps(_mm256_set1_epi32(113 << 23)));
+			o = _mm256_blendv_epi8(o, _mm256_castps_si256(denormal), _mm256_cmpeq_epi32(exponent, _mm256_setzero_si256()));
+			return _mm256_castsi256_ps(_mm256_or_si256(o, _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0x8000)), 16)));
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256 HalfToFloat_AVX2(__m128i half) noexcept
+		{
+#ifdef VECTOR_CODEC_F16C
+			return _mm256_cvtph_ps(half);
+#else
+			return HalfToFloatFallback_AVX2(half);
+#endif
+		}
+
+		// Returns the narrowest type that every value of the block converts to and back bit for bit.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		DowncastType DowncastChoose_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+		{
+			__m256i int8 = _mm256_set1_epi32(-1);
+			__m256i int16 = _mm256_set1_epi32(-1);
+			__m256i bfloat16 = _mm256_setzero_si256();
+#ifdef VECTOR_CODEC_F16C
+			__m256i float16 = _mm256_set1_epi32(-1);
+#endif
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				__m256 vec = _mm256_setzero_ps();
+				size_t n = value_count - i;
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values + i, n << 2);
+				else
+					vec = _mm256_loadu_ps(values + i);
+				const __m256i bits = _mm256_castps_si256(vec);
+				const __m256i integer = _mm256_cvttps_epi32(vec);
+				const __m256i exact = _mm256_cmpeq_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(integer)), bits);
+				int16 = _mm256_and_si256(int16, _mm256_and_si256(exact, _mm256_cmpeq_epi32(integer, _mm256_srai_epi32(_mm256_slli_epi32(integer, 16), 16))));
+				int8 = _mm256_and_si256(int8, _mm256_and_si256(exact, _mm256_cmpeq_epi32(integer, _mm256_srai_epi32(_mm256_slli_epi32(integer, 24), 24))));
+				bfloat16 = _mm256_or_si256(bfloat16, _mm256_slli_epi32(bits, 16));
+#ifdef VECTOR_CODEC_F16C
+				float16 = _mm256_and_si256(float16, _mm256_cmpeq_epi32(_mm256_castps_si256(_mm256_cvtph_ps(_mm256_cvtps_ph(vec, _MM_FROUND_TO_NEAREST_INT))), bits));
+#endif
+			}
+			if (_mm256_movemask_epi8(int8) == -1)
+				return DowncastInt8;
+			if (_mm256_movemask_epi8(int16) == -1)
+				return DowncastInt16;
+#ifdef VECTOR_CODEC_F16C
+			if (_mm256_movemask_epi8(float16) == -1)
+				return DowncastFloat16;
+#endif
+			if (_mm256_testz_si256(bfloat16, bfloat16))
+				return DowncastBFloat16;
+			return DowncastFloat32;
+		}
+
+		// Narrows 8 values to the given type, returning the low DowncastWidths[type] * 8 bytes of the result.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m128i DowncastVector_AVX2(__m256 vec, DowncastType type) noexcept
+		{
+			const __m256i bits = _mm256_castps_si256(vec);
+			switch (type)
+			{
+			case DowncastInt8:
+			case DowncastInt16:
+			{
+				const __m256i integer = _mm256_cvttps_epi32(vec);
+				__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(integer), _mm256_extracti128_si256(integer, 1));
+				return type == DowncastInt8 ? _mm_packs_epi16(words, words) : words;
+			}
+#ifdef VECTOR_CODEC_F16C
+			case DowncastFloat16:
+				return _mm256_cvtps_ph(vec, _MM_FROUND_TO_NEAREST_INT);
+#endif
+			case DowncastBFloat16:
+			{
+				const __m256i high = _mm256_srli_epi32(bits, 16);
+				return _mm_packus_epi32(_mm256_castsi256_si128(high), _mm256_extracti128_si256(high, 1));
+			}
+			default:
+				VECTOR_CODEC_UNREACHABLE;
+			}
+		}
+
+		// Each block is a type tag followed by the values at that width.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint8_t* EncodeDowncastBlock_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const DowncastType type = DowncastChoose_AVX2(values, value_count);
+			const size_t width = DowncastWidths[type];
+			*out = (uint8_t)type;
+			++out;
+			VECTOR_CODEC_UNLIKELY_IF(type == DowncastFloat32)
+			{
+				VECTOR_CODEC_MEMCPY(out, values, value_count << 2);
+				return out + (value_count << 2);
+			}
+			for (size_t j = 0; j < value_count; j += 8)
+			{
+				__m256 vec = _mm256_setzero_ps();
+				size_t n = value_count - j;
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+				{
+					VECTOR_CODEC_MEMCPY(&vec, values + j, n << 2);
+					__m128i narrow = DowncastVector_AVX2(vec, type);
+					VECTOR_CODEC_MEMCPY(out, &narrow, n * width);
+					out += n * width;
+					break;
+				}
+				vec = _mm256_loadu_ps(values + j);
+				__m128i narrow = DowncastVector_AVX2(vec, type);
+				if (width == 1)
+					_mm_storel_epi64((__m128i*)out, narrow);
+				else
+					_mm_storeu_si128((__m128i*)out, narrow);
+				out += width * 8;
+			}
+			return out;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeDowncast_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint8_t* const out_begin = out;
+			for (size_t i = 0; i < value_count; i += DowncastBlockSize)
+				out = EncodeDowncastBlock_AVX2(values + i, value_count - i < DowncastBlockSize ? value_count - i : DowncastBlockSize, out);
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256 UpcastVector_AVX2(__m128i narrow, DowncastType type) noexcept
+		{
+			switch (type)
+			{
+			case DowncastInt8:
+				return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(narrow));
+			case DowncastInt16:
+				return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(narrow));
+			case DowncastFloat16:
+				return HalfToFloat_AVX2(narrow);
+			case DowncastBFloat16:
+				return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(narrow), 16));
+			default:
+				VECTOR_CODEC_UNREACHABLE;
+			}
+		}
+
+		template <DowncastType Type>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		const uint8_t* UpcastBlock_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			constexpr size_t width = DowncastWidths[Type];
+			size_t i = 0;
+			for (; i + 8 <= value_count; i += 8)
+			{
+				__m128i narrow = width == 1 ? _mm_loadl_epi64((const __m128i*)(data + i)) : _mm_loadu_si128((const __m128i*)(data + i * width));
+				_mm256_storeu_ps(out + i, UpcastVector_AVX2(narrow, Type));
+			}
+			VECTOR_CODEC_UNLIKELY_IF(i != value_count)
+			{
+				__m128i narrow = _mm_setzero_si128();
+				VECTOR_CODEC_MEMCPY(&narrow, data + i * width, (value_count - i) * width);
+				__m256 vec = UpcastVector_AVX2(narrow, Type);
+				VECTOR_CODEC_MEMCPY(out + i, &vec, (value_count - i) << 2);
+			}
+			return data + value_count * width;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		const uint8_t* DecodeDowncastBlock_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const DowncastType type = (DowncastType)*data;
+			++data;
+			switch (type)
+			{
+			case DowncastInt8:
+				return UpcastBlock_AVX2<DowncastInt8>(data, value_count, out);
+			case DowncastInt16:
+				return UpcastBlock_AVX2<DowncastInt16>(data, value_count, out);
+			case DowncastFloat16:
+				return UpcastBlock_AVX2<DowncastFloat16>(data, value_count, out);
+			case DowncastBFloat16:
+				return UpcastBlock_AVX2<DowncastBFloat16>(data, value_count, out);
+			default:
+				VECTOR_CODEC_MEMCPY(out, data, value_count << 2);
+				return data + (value_count << 2);
+			}
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeDowncast_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			for (size_t i = 0; i < value_count; i += DowncastBlockSize)
+				data = DecodeDowncastBlock_AVX2(data, value_count - i < DowncastBlockSize ? value_count - i : DowncastBlockSize, out + i);
+			_mm256_zeroall();
+		}
+
+		constexpr size_t FixedRateBlockSize = 16;
+		constexpr uint32_t FixedRatePrecision = 32;
+
+		// Coefficient (i, j) of a 4x4 block is stored at i + 4 * j. This orders them by sequency, so bit planes fill from low frequencies.
+		constexpr uint8_t FixedRateOrder[FixedRateBlockSize] = { 0, 1, 4, 5, 2, 8, 6, 9, 3, 12, 10, 7, 13, 11, 14, 15 };
+
+		struct BitWriter
+		{
+			uint8_t* out;
+			uint64_t bits;
+			uint32_t count;
+
+			// Writes the low n bits of value and returns the remaining ones.
+			VECTOR_CODEC_INLINE_ALWAYS
+			uint32_t Write(uint32_t value, uint32_t n) noexcept
+			{
+				bits |= (uint64_t)(value & (uint32_t)((1ULL << n) - 1)) << count;
+				count += n;
+				VECTOR_CODEC_UNLIKELY_IF(count >= 32)
+				{
+					*(uint32_t*)out = (uint32_t)bits;
+					out += 4;
+					bits >>= 32;
+					count -= 32;
+				}
+				return (uint32_t)((uint64_t)value >> n);
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS
+			void Flush() noexcept
+			{
+				for (; count != 0; count -= 8)
+				{
+					*out = (uint8_t)bits;
+					++out;
+					bits >>= 8;
+				}
+			}
+
+			VECTOR_CODEC_INLINE_ALWAYS
+			bool WriteBit(bool bit) noexcept
+			{
+				(void)Write(bit, 1);
+				return bit;
+			}
+		};
+
+		struct BitReader
+		{
+			const uint8_t* data;
+			uint64_t bits;
+			uint32_t count;
+
+			VECTOR_CODEC_INLINE_ALWAYS
+			uint32_t Read(uint32_t n) noexcept
+			{
+				for (; count < n; count += 8)
+				{
+					bits |= (uint64_t)*data << count;
+					++data;
+				}
+				const uint32_t r = (uint32_t)(bits & ((1ULL << n) - 1));
+				bits >>= n;
+				count -= n;
+				return r;
+			}
+		};
+
+		// The zfp orthogonal lifting transform, applied lane-wise to four rows.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void ForwardLift(__m128i& x, __m128i& y, __m128i& z, __m128i& w) noexcept
+		{
+			x = _mm_srai_epi32(_mm_add_epi32(x, w), 1);
+			w = _mm_sub_epi32(w, x);
+			z = _mm_srai_epi32(_mm_add_epi32(z, y), 1);
+			y = _mm_sub_epi32(y, z);
+			x = _mm_srai_epi32(_mm_add_epi32(x, z), 1);
+			z = _mm_sub_epi32(z, x);
+			w = _mm_srai_epi32(_mm_add_epi32(w, y), 1);
+			y = _mm_sub_epi32(y, w);
+			w = _mm_add_epi32(w, _mm_srai_epi32(y, 1));
+			y = _mm_sub_epi32(y, _mm_srai_epi32(w, 1));
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void InverseLift(__m128i& x, __m128i& y, __m128i& z, __m128i& w) noexcept
+		{
+			y = _mm_add_epi32(y, _mm_srai_epi32(w, 1));
+			w = _mm_sub_epi32(w, _mm_srai_epi32(y, 1));
+			y = _mm_add_epi32(y, w);
+			w = _mm_sub_epi32(_mm_slli_epi32(w, 1), y);
+			z = _mm_add_epi32(z, x);
+			x = _mm_sub_epi32(_mm_slli_epi32(x, 1), z);
+			y = _mm_add_epi32(y, z);
+			z = _mm_sub_epi32(_mm_slli_epi32(z, 1), y);
+			w = _mm_add_epi32(w, x);
+			x = _mm_sub_epi32(_mm_slli_epi32(x, 1), w);
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void Transpose4x4(__m128i& a, __m128i& b, __m128i& c, __m128i& d) noexcept
+		{
+			__m128i ab_low = _mm_unpacklo_epi32(a, b);
+			__m128i ab_high = _mm_unpackhi_epi32(a, b);
+			__m128i cd_low = _mm_unpacklo_epi32(c, d);
+			__m128i cd_high = _mm_unpackhi_epi32(c, d);
+			a = _mm_unpacklo_epi64(ab_low, cd_low);
+			b = _mm_unpackhi_epi64(ab_low, cd_low);
+			c = _mm_unpacklo_epi64(ab_high, cd_high);
+			d = _mm_unpackhi_epi64(ab_high, cd_high);
+		}
+
+		// Multiplies by 2^exponent in two steps, since the exponent may exceed the range of a float.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256 ScaleByPowerOfTwo_AVX2(__m256 vec, int32_t exponent) noexcept
+		{
+			const int32_t half = exponent / 2;
+			vec = _mm256_mul_ps(vec, _mm256_castsi256_ps(_mm256_set1_epi32((half + 127) << 23)));
+			return _mm256_mul_ps(vec, _mm256_castsi256_ps(_mm256_set1_epi32((exponent - half + 127) << 23)));
+		}
+
+		// Encodes 16 values into exactly bit_budget bits: a nonzero flag, the common exponent, then the bit planes of the transformed
+		// block in negabinary, most significant first, each coded with zfp's group testing.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void EncodeFixedRateBlock_AVX2(const float* VECTOR_CODEC_RESTRICT values, uint32_t bit_budget, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			BitWriter writer = { out, 0, 0 };
+			uint32_t bits = bit_budget;
+			__m256 low = _mm256_loadu_ps(values);
+			__m256 high = _mm256_loadu_ps(values + 8);
+			const __m256i magnitude = _mm256_max_epi32(_mm256_and_si256(_mm256_castps_si256(low), _mm256_set1_epi32(0x7FFFFFFF)), _mm256_and_si256(_mm256_castps_si256(high), _mm256_set1_epi32(0x7FFFFFFF)));
+			const uint32_t largest = (uint32_t)HorizontalMax_AVX2(magnitude);
+			VECTOR_CODEC_UNLIKELY_IF(largest == 0)
+			{
+				(void)writer.WriteBit(false);
+				--bits;
+			}
+			else
+			{
+				// |v| < 2^exponent for every value, so the scaled integers fit in 30 bits and the transform cannot overflow.
+				const int32_t exponent = (int32_t)(largest >> 23) - 126;
+				(void)writer.WriteBit(true);
+				(void)writer.Write((uint32_t)(exponent + 127), 8);
+				bits -= 9;
+				__m256i q_low = _mm256_cvttps_epi32(ScaleByPowerOfTwo_AVX2(low, 30 - exponent));
+				__m256i q_high = _mm256_cvttps_epi32(ScaleByPowerOfTwo_AVX2(high, 30 - exponent));
+				__m128i r0 = _mm256_castsi256_si128(q_low);
+				__m128i r1 = _mm256_extracti128_si256(q_low, 1);
+				__m128i r2 = _mm256_castsi256_si128(q_high);
+				__m128i r3 = _mm256_extracti128_si256(q_high, 1);
+				Transpose4x4(r0, r1, r2, r3);
+				ForwardLift(r0, r1, r2, r3);
+				Transpose4x4(r0, r1, r2, r3);
+				ForwardLift(r0, r1, r2, r3);
+				alignas(32) int32_t coefficients[FixedRateBlockSize];
+				alignas(32) uint32_t ordered[FixedRateBlockSize];
+				_mm_store_si128((__m128i*)coefficients, r0);
+				_mm_store_si128((__m128i*)(coefficients + 4), r1);
+				_mm_store_si128((__m128i*)(coefficients + 8), r2);
+				_mm_store_si128((__m128i*)(coefficients + 12), r3);
+				for (size_t i = 0; i != FixedRateBlockSize; ++i)
+					ordered[i] = (uint32_t)coefficients[FixedRateOrder[i]];
+				const __m256i negabinary = _mm256_set1_epi32((int32_t)0xAAAAAAAAU);
+				q_low = _mm256_xor_si256(_mm256_add_epi32(_mm256_load_si256((const __m256i*)ordered), negabinary), negabinary);
+				q_high = _mm256_xor_si256(_mm256_add_epi32(_mm256_load_si256((const __m256i*)(ordered + 8)), negabinary), negabinary);
+				uint32_t n = 0;
+				for (uint32_t k = FixedRatePrecision; bits != 0 && k-- != 0;)
+				{
+					const __m128i shift = _mm_cvtsi32_si128((int)(31 - k));
+					uint32_t x = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_sll_epi32(q_low, shift)));
+					x |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_sll_epi32(q_high, shift))) << 8;
+					// The first n coefficients are already significant and are sent verbatim.
+					const uint32_t m = n < bits ? n : bits;
+					bits -= m;
+					x = writer.Write(x, m);
+					// The rest is sent as a unary run length code of the position of the next significant coefficient.
+					for (; n < FixedRateBlockSize && bits != 0 && (--bits, writer.WriteBit(x != 0)); x >>= 1, ++n)
+						for (; n < FixedRateBlockSize - 1 && bits != 0 && (--bits, !writer.WriteBit(x & 1)); x >>= 1, ++n)
+							;
+				}
+			}
+			// Pad the block to exactly bit_budget bits.
+			for (; bits >= 32; bits -= 32)
+				(void)writer.Write(0, 32);
+			(void)writer.Write(0, bits);
+			writer.Flush();
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void DecodeFixedRateBlock_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, uint32_t bit_budget, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			BitReader reader = { data, 0, 0 };
+			uint32_t bits = bit_budget - 1;
+			VECTOR_CODEC_UNLIKELY_IF(reader.Read(1) == 0)
+			{
+				_mm256_storeu_ps(out, _mm256_setzero_ps());
+				_mm256_storeu_ps(out + 8, _mm256_setzero_ps());
+				return;
+			}
+			const int32_t exponent = (int32_t)reader.Read(8) - 127;
+			bits -= 8;
+			const __m256i lanes_low = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+			const __m256i lanes_high = _mm256_slli_epi32(lanes_low, 8);
+			__m256i q_low = _mm256_setzero_si256();
+			__m256i q_high = _mm256_setzero_si256();
+			uint32_t n = 0;
+			for (uint32_t k = FixedRatePrecision; bits != 0 && k-- != 0;)
+			{
+				const uint32_t m = n < bits ? n : bits;
+				bits -= m;
+				uint32_t x = reader.Read(m);
+				for (; n < FixedRateBlockSize && bits != 0 && (--bits, reader.Read(1) != 0); x += 1U << n++)
+					for (; n < FixedRateBlockSize - 1 && bits != 0 && (--bits, reader.Read(1) == 0); ++n)
+						;
+				// Deposit the bit plane in every lane at once.
+				const __m256i plane = _mm256_set1_epi32((int32_t)x);
+				const __m256i bit = _mm256_set1_epi32((int32_t)(1U << k));
+				q_low = _mm256_or_si256(q_low, _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(plane, lanes_low), lanes_low), bit));
+				q_high = _mm256_or_si256(q_high, _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(plane, lanes_high), lanes_high), bit));
+			}
+			const __m256i negabinary = _mm256_set1_epi32((int32_t)0xAAAAAAAAU);
+			alignas(32) int32_t ordered[FixedRateBlockSize];
+			alignas(32) int32_t coefficients[FixedRateBlockSize];
+			_mm256_store_si256((__m256i*)ordered, _mm256_sub_epi32(_mm256_xor_si256(q_low, negabinary), negabinary));
+			_mm256_store_si256((__m256i*)(ordered + 8), _mm256_sub_epi32(_mm256_xor_si256(q_high, negabinary), negabinary));
+			for (size_t i = 0; i != FixedRateBlockSize; ++i)
+				coefficients[FixedRateOrder[i]] = ordered[i];
+			__m128i r0 = _mm_load_si128((const __m128i*)coefficients);
+			__m128i r1 = _mm_load_si128((const __m128i*)(coefficients + 4));
+			__m128i r2 = _mm_load_si128((const __m128i*)(coefficients + 8));
+			__m128i r3 = _mm_load_si128((const __m128i*)(coefficients + 12));
+			InverseLift(r0, r1, r2, r3);
+			Transpose4x4(r0, r1, r2, r3);
+			InverseLift(r0, r1, r2, r3);
+			Transpose4x4(r0, r1, r2, r3);
+			_mm256_storeu_ps(out, ScaleByPowerOfTwo_AVX2(_mm256_cvtepi32_ps(_mm256_set_m128i(r1, r0)), exponent - 30));
+			_mm256_storeu_ps(out + 8, ScaleByPowerOfTwo_AVX2(_mm256_cvtepi32_ps(_mm256_set_m128i(r3, r2)), exponent - 30));
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeFixedRate_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint32_t rate, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint8_t* const out_begin = out;
+			const uint32_t bit_budget = rate * FixedRateBlockSize;
+			for (size_t i = 0; i < value_count; i += FixedRateBlockSize)
+			{
+				VECTOR_CODEC_UNLIKELY_IF(value_count - i < FixedRateBlockSize)
+				{
+					// A partial block repeats its last value, which costs almost nothing after the transform.
+					alignas(32) float block[FixedRateBlockSize];
+					for (size_t j = 0; j != FixedRateBlockSize; ++j)
+						block[j] = values[i + j < value_count ? i + j : value_count - 1];
+					EncodeFixedRateBlock_AVX2(block, bit_budget, out);
+				}
+				else
+				{
+					EncodeFixedRateBlock_AVX2(values + i, bit_budget, out);
+				}
+				out += bit_budget / 8;
+			}
+			_mm256_zeroall();
+			VECTOR_CODEC_INVARIANT(out >= out_begin);
+			return out - out_begin;
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeFixedRate_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, uint32_t rate, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const uint32_t bit_budget = rate * FixedRateBlockSize;
+			for (size_t i = 0; i < value_count; i += FixedRateBlockSize)
+			{
+				VECTOR_CODEC_UNLIKELY_IF(value_count - i < FixedRateBlockSize)
+				{
+					alignas(32) float block[FixedRateBlockSize];
+					DecodeFixedRateBlock_AVX2(data, bit_budget, block);
+					VECTOR_CODEC_MEMCPY(out + i, block, (value_count - i) << 2);
+				}
+				else
+				{
+					DecodeFixedRateBlock_AVX2(data, bit_budget, out + i);
+				}
+				data += bit_budget / 8;
+			}
+			_mm256_zeroall();
+		}
+
+		constexpr size_t BudgetSegmentSize = 1024;
+		constexpr uint32_t BudgetLevels = 4;
+		constexpr uint32_t BudgetDroppedBits[BudgetLevels] = { 0, 8, 16, 23 };
+		constexpr uint32_t BudgetRetries = 8;
+
+		// The measured size and squared error of a segment at every precision level.
+		struct BudgetSegment
+		{
+			uint32_t sizes[BudgetLevels];
+			double errors[BudgetLevels];
+		};
+
+		static_assert(sizeof(BudgetSegment) == 48, "UpperBoundToBudget assumes 48 bytes per segment.");
+
+		// Rounds the mantissas to nearest, keeping infinities and NaNs and rounding down where rounding up would overflow.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i QuantizeMantissa_AVX2(__m256i bits, uint32_t dropped) noexcept
+		{
+			VECTOR_CODEC_UNLIKELY_IF(dropped == 0)
+				return bits;
+			const __m256i mask = _mm256_set1_epi32((int32_t)~((1U << dropped) - 1));
+			const __m256i exponent = _mm256_set1_epi32(0x7F800000);
+			__m256i rounded = _mm256_and_si256(_mm256_add_epi32(bits, _mm256_set1_epi32((int32_t)(1U << (dropped - 1)))), mask);
+			rounded = _mm256_blendv_epi8(rounded, _mm256_and_si256(bits, mask), _mm256_cmpeq_epi32(_mm256_and_si256(rounded, exponent), exponent));
+			return _mm256_blendv_epi8(rounded, bits, _mm256_cmpeq_epi32(_mm256_and_si256(bits, exponent), exponent));
+		}
+
+		// Writes the quantized segment to out and returns its squared error.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		double QuantizeSegment_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint32_t dropped, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			__m256d error = _mm256_setzero_pd();
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				__m256i vec = _mm256_setzero_si256();
+				size_t n = value_count - i;
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values + i, n << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)(values + i));
+				const __m256i quantized = QuantizeMantissa_AVX2(vec, dropped);
+				__m256 difference = _mm256_sub_ps(_mm256_castsi256_ps(vec), _mm256_castsi256_ps(quantized));
+				difference = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(vec, quantized)), difference);
+				const __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(difference));
+				const __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(difference, 1));
+				error = _mm256_add_pd(error, _mm256_add_pd(_mm256_mul_pd(low, low), _mm256_mul_pd(high, high)));
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(out + i, &quantized, n << 2);
+				else
+					_mm256_storeu_si256((__m256i*)(out + i), quantized);
+			}
+			alignas(32) double lanes[4];
+			_mm256_store_pd(lanes, error);
+			return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		}
+
+		// Picks for every segment the level that minimizes error + lambda * size and returns the estimated total size.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		size_t BudgetPlan(const BudgetSegment* VECTOR_CODEC_RESTRICT segments, size_t segment_count, double lambda, uint8_t* VECTOR_CODEC_RESTRICT levels) noexcept
+		{
+			size_t total = 0;
+			for (size_t i = 0; i != segment_count; ++i)
+			{
+				uint32_t best = 0;
+				for (uint32_t j = 1; j != BudgetLevels; ++j)
+					if (segments[i].errors[j] + lambda * segments[i].sizes[j] < segments[i].errors[best] + lambda * segments[i].sizes[best])
+						best = j;
+				if (levels != nullptr)
+					levels[i] = (uint8_t)best;
+				total += segments[i].sizes[best];
+			}
+			return total;
+		}
+
+		// The working space after the UpperBound bytes of output holds the quantized copy of the values and the per-segment measurements.
+		// Segment sizes are measured by encoding each segment on its own, so the final Encode of the whole array may differ slightly; when it
+		// overshoots, the plan is redone against a target lowered by the excess.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeToBudget_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, size_t target_bytes, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const size_t lossless = Encode_AVX2<ISA>(values, value_count, out);
+			if (lossless <= target_bytes)
+				return lossless;
+			float* const quantized = (float*)(out + UpperBound(value_count));
+			const uintptr_t segments_address = ((uintptr_t)(quantized + value_count) + 7) & ~(uintptr_t)7;
+			BudgetSegment* const segments = (BudgetSegment*)segments_address;
+			const size_t segment_count = (value_count + BudgetSegmentSize - 1) / BudgetSegmentSize;
+			alignas(32) uint8_t scratch[UpperBound(BudgetSegmentSize)];
+			for (size_t i = 0; i != segment_count; ++i)
+			{
+				const size_t first = i * BudgetSegmentSize;
+				const size_t n = value_count - first < BudgetSegmentSize ? value_count - first : BudgetSegmentSize;
+				for (uint32_t j = 0; j != BudgetLevels; ++j)
+				{
+					segments[i].errors[j] = QuantizeSegment_AVX2(values + first, n, BudgetDroppedBits[j], quantized + first);
+					segments[i].sizes[j] = (uint32_t)Encode_AVX2<ISA>(quantized + first, n, scratch);
+				}
+			}
+			uint8_t levels[BudgetSegmentSize];
+			size_t target = target_bytes;
+			for (uint32_t attempt = 0; attempt != BudgetRetries; ++attempt)
+			{
+				double lambda = 0.0;
+				if (BudgetPlan(segments, segment_count, lambda, nullptr) > target)
+				{
+					// Bisect log2(lambda); errors and sizes are both finite, so 2^200 always reaches the smallest sizes.
+					double low = -200.0;
+					double high = 200.0;
+					VECTOR_CODEC_UNLIKELY_IF(BudgetPlan(segments, segment_count, exp2(high), nullptr) > target)
+						return 0;
+					for (uint32_t i = 0; i != 64; ++i)
+					{
+						const double middle = (low + high) * 0.5;
+						if (BudgetPlan(segments, segment_count, exp2(middle), nullptr) > target)
+							low = middle;
+						else
+							high = middle;
+					}
+					lambda = exp2(high);
+				}
+				// The plan is applied in groups so that the chosen levels fit on the stack.
+				for (size_t i = 0; i < segment_count; i += BudgetSegmentSize)
+				{
+					const size_t group = segment_count - i < BudgetSegmentSize ? segment_count - i : BudgetSegmentSize;
+					(void)BudgetPlan(segments + i, group, lambda, levels);
+					for (size_t j = 0; j != group; ++j)
+					{
+						const size_t first = (i + j) * BudgetSegmentSize;
+						const size_t n = value_count - first < BudgetSegmentSize ? value_count - first : BudgetSegmentSize;
+						(void)QuantizeSegment_AVX2(values + first, n, BudgetDroppedBits[levels[j]], quantized + first);
+					}
+				}
+				const size_t size = Encode_AVX2<ISA>(quantized, value_count, out);
+				if (size <= target_bytes)
+					return size;
+				VECTOR_CODEC_UNLIKELY_IF(size - target_bytes >= target)
+					return 0;
+				target -= size - target_bytes;
+			}
+			return 0;
+		}
+
+		// Maps a format to its codec. Returns 0 when the codec does not apply to the values.
+		static size_t EncodeFormat(Format format, const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			switch (format)
+			{
+			case Format::Default:
+				return Dispatch([&](auto isa) { return Encode_AVX2<decltype(isa)>(values, value_count, out); });
+			case Format::Quick:
+				return Dispatch([&](auto isa) { return EncodeQuick_AVX2<decltype(isa)>(values, value_count, out); });
+			case Format::Compact:
+				return Dispatch([&](auto isa) { return EncodeCompact_AVX2<decltype(isa)>(values, value_count, out); });
+			case Format::Chimp:
+				return Dispatch([&](auto isa) { return EncodeChimp_AVX2<decltype(isa)>(values, value_count, out); });
+			case Format::ALP:
+				return EncodeALP_AVX2(values, value_count, out);
+			case Format::Dictionary:
+				return EncodeDictionary_AVX2(values, value_count, out);
+			case Format::RLE:
+				return EncodeRLE_AVX2(values, value_count, out);
+			case Format::Downcast:
+				return EncodeDowncast_AVX2(values, value_count, out);
+			default:
+				VECTOR_CODEC_UNREACHABLE;
+			}
+		}
+
+		static void DecodeFormat(Format format, const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			switch (format)
+			{
+			case Format::Default:
+				return Dispatch([&](auto isa) { Decode_AVX2<decltype(isa)>(data, value_count, out); });
+			case Format::Quick:
+				return Dispatch([&](auto isa) { DecodeQuick_AVX2<decltype(isa)>(data, value_count, out); });
+			case Format::Compact:
+				return Dispatch([&](auto isa) { DecodeCompact_AVX2<decltype(isa)>(data, value_count, out); });
+			case Format::Chimp:
+				return Dispatch([&](auto isa) { DecodeChimp_AVX2<decltype(isa)>(data, value_count, out); });
+			case Format::ALP:
+				return DecodeALP_AVX2(data, value_count, out);
+			case Format::Dictionary:
+				return DecodeDictionary_AVX2(data, value_count, out);
+			case Format::RLE:
+				return DecodeRLE_AVX2(data, value_count, out);
+			case Format::Downcast:
+				return DecodeDowncast_AVX2(data, value_count, out);
+			default:
+				VECTOR_CODEC_UNREACHABLE;
+			}
+		}
+
+		// The fewest bytes that value_count values take in format, whatever the values. An index that gives a smaller size is corrupt.
+		constexpr size_t MinimumSize(Format format, size_t value_count) noexcept
+		{
+			const size_t blocks = (value_count + 7) / 8;
+			if (value_count == 0)
+				return 0;
+			switch (format)
+			{
+			case Format::Default:
+			case Format::Quick:
+				return blocks * 4;
+			case Format::Compact:
+				return blocks * 2 + (blocks + 7) / 8;
+			case Format::Chimp:
+				return blocks * 5;
+			case Format::ALP:
+				return (value_count + ALPBlockSize - 1) / ALPBlockSize * 8 + 16;
+			case Format::Dictionary:
+				return 16;
+			case Format::RLE:
+				return (value_count + RLEMaxLength - 1) / RLEMaxLength * 8;
+			default:
+				return value_count + (value_count + DowncastBlockSize - 1) / DowncastBlockSize;
+			}
+		}
+
+		// Default and Quick share the header layout and the residual coding, they only differ in the predictor, so the decoder of one can feed
+		// the encoder of the other one block at a time. The zero lanes past the end of the source decode to zeros, just like Encode pads them.
+		template <typename ISA, Format Source, Format Target>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t TranscodePredictor_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			alignas(64) int32_t source_lookup[LookupSize] = {};
+			alignas(64) int32_t target_lookup[LookupSize] = {};
+			__m256i source_indices = _mm256_setzero_si256();
+			__m256i source_predicted = _mm256_setzero_si256();
+			__m256i target_indices = _mm256_setzero_si256();
+			__m256i target_predicted = _mm256_setzero_si256();
+			const uint8_t* const out_begin = out;
+			const size_t header_size = ((value_count + 7) & ~(size_t)7) / 2;
+			const uint32_t* in_headers = (const uint32_t*)data;
+			uint32_t* out_headers = (uint32_t*)out;
+			data += header_size;
+			out += header_size;
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				const __m256i residual = ISA::DecodeResidual(VECTOR_CODEC_BSWAP_IF_BE(*in_headers), data);
+				++in_headers;
+				__m256i vec;
+				if constexpr (Source == Format::Default)
+				{
+					vec = PredictBlock_AVX2<ISA>(source_lookup, source_indices, source_predicted, residual);
+				}
+				else
+				{
+					vec = _mm256_add_epi32(residual, source_predicted);
+					source_predicted = vec;
+				}
+				uint32_t header;
+				if constexpr (Target == Format::Default)
+				{
+					header = EncodeBlock_AVX2<ISA>(target_lookup, target_indices, target_predicted, vec, out);
+				}
+				else
+				{
+					header = ISA::EncodeResidual(_mm256_sub_epi32(vec, target_predicted), out);
+					target_predicted = vec;
+				}
+				*out_headers = VECTOR_CODEC_BSWAP_IF_BE(header);
+				++out_headers;
+			}
+			_mm256_zeroall();
+			return out - out_begin;
+		}
+
+		// Other conversions go through a tile of TranscodeTileSize values: the reader decodes the next tile of the source and the writer
+		// appends it to the target, each keeping the state of its codec from one tile to the next. A tile is exactly one ALP or Downcast
+		// block, and a whole number of 8-value blocks for the predictor based codecs, so the output is the same as encoding the whole array.
+		constexpr size_t TranscodeTileSize = 1024;
+		static_assert(TranscodeTileSize == ALPBlockSize && TranscodeTileSize == DowncastBlockSize, "A tile must be one block of the block based codecs.");
+
+		// Each source format only uses the fields it needs.
+		struct TileReader
+		{
+			alignas(64) int32_t lookup[LookupSize];
+			alignas(64) int32_t ring[ChimpWindow];
+			__m256i indices, predicted;
+			const uint8_t* data;
+			const uint8_t* headers;
+			const uint8_t* flags;
+			const uint8_t* run_value;
+			size_t block;
+			size_t run_length;
+			uint32_t position;
+			uint32_t count;
+			bool run_literal;
+			Format format;
+		};
+
+		static void ReaderInit(TileReader& reader, Format format, const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count) noexcept
+		{
+			reader.format = format;
+			reader.block = 0;
+			reader.run_length = 0;
+			reader.position = 0;
+			reader.headers = data;
+			reader.data = data;
+			switch (format)
+			{
+			case Format::Default:
+			case Format::Quick:
+				reader.data = data + ((value_count + 7) & ~(size_t)7) / 2;
+				break;
+			case Format::Compact:
+				reader.flags = data + (value_count + 7) / 8 * 2;
+				reader.data = reader.flags + ((value_count + 7) / 8 + 7) / 8;
+				break;
+			case Format::Chimp:
+				for (int32_t& e : reader.ring)
+					e = 0;
+				reader.data = data + ((value_count + 7) & ~(size_t)7) / 2;
+				break;
+			case Format::Dictionary:
+				VECTOR_CODEC_UNLIKELY_IF(value_count == 0)
+					break;
+				reader.count = VECTOR_CODEC_BSWAP_IF_BE(*(const uint32_t*)data);
+				reader.data = data + 4 + reader.count * 4;
+				break;
+			default:
+				break;
+			}
+			for (int32_t& e : reader.lookup)
+				e = 0;
+			reader.indices = reader.predicted = _mm256_setzero_si256();
+		}
+
+		// Decodes the next value_count values, at most TranscodeTileSize, and a multiple of 8 unless they are the last ones.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void ReadTile_AVX2(TileReader& reader, float* VECTOR_CODEC_RESTRICT out, size_t value_count) noexcept
+		{
+			auto store = [&](size_t i, __m256i vec)
+			{
+				VECTOR_CODEC_UNLIKELY_IF(value_count - i < 8)
+					VECTOR_CODEC_MEMCPY(out + i, &vec, (value_count - i) << 2);
+				else
+					_mm256_storeu_si256((__m256i*)(out + i), vec);
+			};
+			const uint32_t* const headers = (const uint32_t*)reader.headers;
+			switch (reader.format)
+			{
+			case Format::Default:
+				for (size_t i = 0; i < value_count; i += 8, ++reader.block)
+					store(i, PredictBlock_AVX2<ISA>(reader.lookup, reader.indices, reader.predicted, ISA::DecodeResidual(VECTOR_CODEC_BSWAP_IF_BE(headers[reader.block]), reader.data)));
+				break;
+			case Format::Quick:
+				for (size_t i = 0; i < value_count; i += 8, ++reader.block)
+				{
+					reader.predicted = _mm256_add_epi32(ISA::DecodeResidual(VECTOR_CODEC_BSWAP_IF_BE(headers[reader.block]), reader.data), reader.predicted);
+					store(i, reader.predicted);
+				}
+				break;
+			case Format::Compact:
+				for (size_t i = 0; i < value_count; i += 8, ++reader.block)
+					store(i, DecodeCompactBlock_AVX2<ISA>(reader.lookup, reader.indices, reader.predicted, (const uint16_t*)reader.headers, reader.flags, reader.block, reader.data));
+				break;
+			case Format::Chimp:
+				for (size_t i = 0; i < value_count; i += 8, ++reader.block)
+					store(i, DecodeChimpBlock_AVX2<ISA>(reader.ring, reader.position, VECTOR_CODEC_BSWAP_IF_BE(headers[reader.block]), reader.data));
+				break;
+			case Format::ALP:
+				reader.data = DecodeALPBlock_AVX2(reader.data, value_count, out);
+				break;
+			case Format::Dictionary:
+				reader.data = DecodeDictionaryGroups_AVX2((const float*)(reader.headers + 4), reader.count, reader.data, value_count, out);
+				break;
+			case Format::RLE:
+				for (size_t i = 0; i != value_count;)
+				{
+					if (reader.run_length == 0)
+					{
+						const uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*(const uint32_t*)reader.data);
+						reader.data += 4;
+						reader.run_length = header & ~RLELiteral;
+						reader.run_literal = (header & RLELiteral) != 0;
+						reader.run_value = reader.data;
+						reader.data += reader.run_literal ? reader.run_length << 2 : 4;
+					}
+					const size_t n = reader.run_length < value_count - i ? reader.run_length : value_count - i;
+					if (reader.run_literal)
+					{
+						VECTOR_CODEC_MEMCPY(out + i, reader.run_value, n << 2);
+						reader.run_value += n << 2;
+					}
+					else
+					{
+						const float value = *(const float*)reader.run_value;
+						for (size_t j = 0; j != n; ++j)
+							out[i + j] = value;
+					}
+					reader.run_length -= n;
+					i += n;
+				}
+				break;
+			case Format::Downcast:
+				reader.data = DecodeDowncastBlock_AVX2(reader.data, value_count, out);
+				break;
+			default:
+				VECTOR_CODEC_UNREACHABLE;
+			}
+		}
+
+		// Each target format only uses the fields it needs. Dictionary and RLE have no writer.
+		struct TileWriter
+		{
+			alignas(64) int32_t lookup[LookupSize];
+			alignas(64) int32_t ring[ChimpWindow];
+			alignas(64) int32_t positions[1U << ChimpIndexBits];
+			__m256i indices, predicted, position;
+			uint8_t* out_begin;
+			uint8_t* out;
+			uint8_t* headers;
+			uint8_t* flags;
+			size_t block;
+			Format format;
+		};
+
+		static void WriterInit(TileWriter& writer, Format format, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			writer.format = format;
+			writer.block = 0;
+			writer.out_begin = out;
+			writer.headers = out;
+			writer.out = out;
+			switch (format)
+			{
+			case Format::Default:
+			case Format::Quick:
+				writer.out = out + ((value_count + 7) & ~(size_t)7) / 2;
+				break;
+			case Format::Compact:
+				writer.flags = out + (value_count + 7) / 8 * 2;
+				writer.out = writer.flags + ((value_count + 7) / 8 + 7) / 8;
+				for (uint8_t* flags = writer.flags; flags != writer.out; ++flags)
+					*flags = 0;
+				break;
+			case Format::Chimp:
+				for (int32_t& e : writer.ring)
+					e = 0;
+				for (int32_t& e : writer.positions)
+					e = 0;
+				writer.position = _mm256_set_epi32(ChimpWindow + 7, ChimpWindow + 6, ChimpWindow + 5, ChimpWindow + 4, ChimpWindow + 3, ChimpWindow + 2, ChimpWindow + 1, ChimpWindow);
+				writer.out = out + ((value_count + 7) & ~(size_t)7) / 2;
+				break;
+			default:
+				break;
+			}
+			for (int32_t& e : writer.lookup)
+				e = 0;
+			writer.indices = writer.predicted = _mm256_setzero_si256();
+		}
+
+		// Encodes the next value_count values, with the same constraints as ReadTile_AVX2. The lanes past the end of the last block are
+		// zeroed, just like the encoders pad them.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void WriteTile_AVX2(TileWriter& writer, const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+		{
+			auto load = [&](size_t i)
+			{
+				__m256i vec = _mm256_setzero_si256();
+				VECTOR_CODEC_UNLIKELY_IF(value_count - i < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values + i, (value_count - i) << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)(values + i));
+				return vec;
+			};
+			uint32_t* const headers = (uint32_t*)writer.headers;
+			switch (writer.format)
+			{
+			case Format::Default:
+				for (size_t i = 0; i < value_count; i += 8, ++writer.block)
+					headers[writer.block] = VECTOR_CODEC_BSWAP_IF_BE(EncodeBlock_AVX2<ISA>(writer.lookup, writer.indices, writer.predicted, load(i), writer.out));
+				break;
+			case Format::Quick:
+				for (size_t i = 0; i < value_count; i += 8, ++writer.block)
+				{
+					const __m256i vec = load(i);
+					headers[writer.block] = VECTOR_CODEC_BSWAP_IF_BE(ISA::EncodeResidual(_mm256_sub_epi32(vec, writer.predicted), writer.out));
+					writer.predicted = vec;
+				}
+				break;
+			case Format::Compact:
+				for (size_t i = 0; i < value_count; i += 8, ++writer.block)
+					EncodeCompactBlock_AVX2<ISA>(writer.lookup, writer.indices, writer.predicted, load(i), (uint16_t*)writer.headers, writer.flags, writer.block, writer.out);
+				break;
+			case Format::Chimp:
+				for (size_t i = 0; i < value_count; i += 8, ++writer.block)
+					headers[writer.block] = VECTOR_CODEC_BSWAP_IF_BE(EncodeChimpBlock_AVX2<ISA>(writer.ring, writer.positions, writer.position, load(i), writer.out));
+				break;
+			case Format::ALP:
+				writer.out = EncodeALPBlock_AVX2(values, value_count, writer.out);
+				break;
+			case Format::Downcast:
+				writer.out = EncodeDowncastBlock_AVX2(values, value_count, writer.out);
+				break;
+			default:
+				VECTOR_CODEC_UNREACHABLE;
+			}
+		}
+
+		static size_t WriterFinish(TileWriter& writer) noexcept
+		{
+			// The ALP decoder reads up to 16 bytes past the last packed group.
+			if (writer.format == Format::ALP)
+			{
+				_mm_storeu_si128((__m128i*)writer.out, _mm_setzero_si128());
+				writer.out += 16;
+			}
+			VECTOR_CODEC_INVARIANT(writer.out >= writer.out_begin);
+			return writer.out - writer.out_begin;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t Transcode_AVX2(Format source_format, Format target_format, const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const bool source_predictor = source_format == Format::Default || source_format == Format::Quick;
+			const bool target_predictor = target_format == Format::Default || target_format == Format::Quick;
+			if (source_predictor && target_predictor)
+			{
+				if (source_format == Format::Default)
+				{
+					if (target_format == Format::Default)
+						return TranscodePredictor_AVX2<ISA, Format::Default, Format::Default>(data, value_count, out);
+					return TranscodePredictor_AVX2<ISA, Format::Default, Format::Quick>(data, value_count, out);
+				}
+				if (target_format == Format::Default)
+					return TranscodePredictor_AVX2<ISA, Format::Quick, Format::Default>(data, value_count, out);
+				return TranscodePredictor_AVX2<ISA, Format::Quick, Format::Quick>(data, value_count, out);
+			}
+			TileReader reader;
+			ReaderInit(reader, source_format, data, value_count);
+			// Dictionary and RLE need the whole array before they emit anything, so it is decoded past the end of their output.
+			if (target_format == Format::Dictionary || target_format == Format::RLE)
+			{
+				const size_t bound = target_format == Format::Dictionary ? UpperBoundDictionary(value_count) : UpperBoundRLE(value_count);
+				float* const values = (float*)(((uintptr_t)(out + bound) + 31) & ~(uintptr_t)31);
+				for (size_t i = 0; i < value_count; i += TranscodeTileSize)
+					ReadTile_AVX2<ISA>(reader, values + i, value_count - i < TranscodeTileSize ? value_count - i : TranscodeTileSize);
+				const size_t size = EncodeFormat(target_format, values, value_count, out);
+				return size != 0 || value_count == 0 ? size : SIZE_MAX;
+			}
+			TileWriter writer;
+			WriterInit(writer, target_format, value_count, out);
+			alignas(32) float tile[TranscodeTileSize];
+			for (size_t i = 0; i < value_count; i += TranscodeTileSize)
+			{
+				const size_t n = value_count - i < TranscodeTileSize ? value_count - i : TranscodeTileSize;
+				ReadTile_AVX2<ISA>(reader, tile, n);
+				WriteTile_AVX2<ISA>(writer, tile, n);
+			}
+			_mm256_zeroall();
+			return WriterFinish(writer);
+		}
+
+		constexpr size_t AutoSampleRuns = 4;
+
+		// The predictor based codecs are tried on up to AutoSampleRuns runs of ALPBlockSize contiguous values spread over the array.
+		// The size of a dictionary is known exactly once its entries are counted, so it is computed over the whole array.
+		static Format ChooseFormat(const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+		{
+			constexpr Format candidates[] = { Format::Default, Format::Quick, Format::Compact, Format::Chimp, Format::ALP, Format::RLE, Format::Downcast };
+			alignas(32) uint8_t scratch[UpperBoundChimp(ALPBlockSize)];
+			size_t sizes[sizeof(candidates) / sizeof(candidates[0])] = {};
+			const size_t run = value_count < ALPBlockSize ? value_count : ALPBlockSize;
+			const size_t runs = (value_count + ALPBlockSize - 1) / ALPBlockSize < AutoSampleRuns ? (value_count + ALPBlockSize - 1) / ALPBlockSize : AutoSampleRuns;
+			for (size_t i = 0; i != runs; ++i)
+			{
+				const float* sample = values + (runs > 1 ? (value_count - run) / (runs - 1) * i : 0);
+				for (size_t j = 0; j != sizeof(candidates) / sizeof(candidates[0]); ++j)
+				{
+					const size_t k = EncodeFormat(candidates[j], sample, run, scratch);
+					sizes[j] += k != 0 ? k : UpperBoundChimp(run);
+				}
+			}
+			Format best = Format::Default;
+			size_t best_size = SIZE_MAX;
+			for (size_t j = 0; j != sizeof(candidates) / sizeof(candidates[0]); ++j)
+			{
+				VECTOR_CODEC_UNLIKELY_IF(runs == 0)
+					break;
+				const size_t size = (size_t)((double)sizes[j] * value_count / (run * runs));
+				if (size < best_size)
+				{
+					best = candidates[j];
+					best_size = size;
+				}
+			}
+			DictionaryTable table;
+			VECTOR_CODEC_UNLIKELY_IF(value_count != 0 && DictionaryBuild_AVX2(table, values, value_count))
+			{
+				const size_t size = 4 + table.count * 4 + (value_count + 7) / 8 * BitWidth(table.count - 1) + 8;
+				if (size <= best_size)
+					best = Format::Dictionary;
+			}
+			_mm256_zeroall();
+			return best;
+		}
+
+		constexpr uint32_t ProgressivePlanes = 4;
+		constexpr size_t ProgressivePrefixSize = ProgressivePlanes * 8;
+
+		// Computes the Encode size classes of a residual: the trailing zero bytes, capped at 3, and the code of the remaining payload.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t ProgressiveHeader_AVX2(__m256i residual) noexcept
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			__m256i tzcounts = _mm256_cmpeq_epi32(_mm256_and_si256(residual, _mm256_set1_epi32(0xFF)), zero);
+			tzcounts = _mm256_add_epi32(tzcounts, _mm256_cmpeq_epi32(_mm256_and_si256(residual, _mm256_set1_epi32(0xFFFF)), zero));
+			tzcounts = _mm256_add_epi32(tzcounts, _mm256_cmpeq_epi32(_mm256_and_si256(residual, _mm256_set1_epi32(0xFFFFFF)), zero));
+			tzcounts = _mm256_sub_epi32(zero, _mm256_add_epi32(tzcounts, _mm256_cmpeq_epi32(residual, zero)));
+			const __m256i shifted = _mm256_srlv_epi32(residual, _mm256_slli_epi32(tzcounts, 3));
+			__m256i lzcounts = _mm256_cmpeq_epi32(_mm256_srli_epi32(shifted, 24), zero);
+			lzcounts = _mm256_add_epi32(lzcounts, _mm256_cmpeq_epi32(_mm256_srli_epi32(shifted, 16), zero));
+			lzcounts = _mm256_add_epi32(lzcounts, _mm256_cmpeq_epi32(_mm256_srli_epi32(shifted, 8), zero));
+			lzcounts = _mm256_sub_epi32(zero, _mm256_add_epi32(lzcounts, _mm256_cmpeq_epi32(shifted, zero)));
+			lzcounts = _mm256_add_epi32(lzcounts, _mm256_cmpgt_epi32(lzcounts, _mm256_set1_epi32(2)));
+			tzcounts = _mm256_sub_epi32(tzcounts, _mm256_srli_epi32(tzcounts, 2));
+			return PackHeader_AVX2(lzcounts, tzcounts);
+		}
+
+		// Byte p of a residual is stored when tz <= p < tz + payload. Returns the lanes that store byte p.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		uint32_t ProgressiveMask_AVX2(__m256i tzcounts, __m256i end, uint32_t plane) noexcept
+		{
+			const __m256i p = _mm256_set1_epi32((int32_t)plane);
+			const __m256i present = _mm256_andnot_si256(_mm256_cmpgt_epi32(tzcounts, p), _mm256_cmpgt_epi32(end, p));
+			return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(present));
+		}
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		void ProgressiveCodes_AVX2(uint32_t header, __m256i& tzcounts, __m256i& end) noexcept
+		{
+			const __m256i lzcodes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int32_t)header), _mm256_set_epi32(14, 12, 10, 8, 6, 4, 2, 0)), _mm256_set1_epi32(3));
+			tzcounts = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int32_t)header), _mm256_set_epi32(30, 28, 26, 24, 22, 20, 18, 16)), _mm256_set1_epi32(3));
+			const __m256i payload = _mm256_sub_epi32(_mm256_set1_epi32(4), _mm256_sub_epi32(lzcodes, _mm256_cmpeq_epi32(lzcodes, _mm256_set1_epi32(3))));
+			end = _mm256_add_epi32(tzcounts, payload);
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS static
+		__m256i ProgressiveResidual_AVX2(int32_t* VECTOR_CODEC_RESTRICT lookup, __m256i& indices, __m256i& predicted, __m256i vec) noexcept
+		{
+			ISA::StoreLookup(lookup, indices, vec);
+			indices = VectorHash_AVX2(vec, indices);
+			vec = _mm256_xor_si256(vec, predicted);
+			predicted = _mm256_i32gather_epi32(lookup, indices, 4);
+			return vec;
+		}
+
+		// Layout: the size of each byte plane as a 64-bit integer, most significant plane first, the headers of Encode, the planes, and 8
+		// bytes of padding. The first pass sizes the planes, the second one runs the predictor again to fill them.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodeProgressive_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			uint64_t sizes[ProgressivePlanes] = {};
+			uint8_t* planes[ProgressivePlanes];
+			uint32_t* const headers = (uint32_t*)(out + ProgressivePrefixSize);
+			for (uint32_t pass = 0; pass != 2; ++pass)
+			{
+				alignas(64) int32_t lookup[LookupSize] = {};
+				__m256i indices = _mm256_setzero_si256();
+				__m256i predicted = _mm256_setzero_si256();
+				for (size_t i = 0; i < value_count; i += 8)
+				{
+					__m256i vec = _mm256_setzero_si256();
+					size_t n = value_count - i;
+					VECTOR_CODEC_UNLIKELY_IF(n < 8)
+						VECTOR_CODEC_MEMCPY(&vec, values + i, n << 2);
+					else
+						vec = _mm256_loadu_si256((const __m256i*)(values + i));
+					const __m256i residual = ProgressiveResidual_AVX2<ISA>(lookup, indices, predicted, vec);
+					uint32_t header;
+					if (pass == 0)
+					{
+						header = ProgressiveHeader_AVX2(residual);
+						headers[i / 8] = VECTOR_CODEC_BSWAP_IF_BE(header);
+					}
+					else
+					{
+						header = VECTOR_CODEC_BSWAP_IF_BE(headers[i / 8]);
+					}
+					__m256i tzcounts, end;
+					ProgressiveCodes_AVX2(header, tzcounts, end);
+					alignas(32) uint32_t lanes[8];
+					_mm256_store_si256((__m256i*)lanes, residual);
+					for (uint32_t p = 0; p != ProgressivePlanes; ++p)
+					{
+						uint32_t mask = ProgressiveMask_AVX2(tzcounts, end, ProgressivePlanes - 1 - p);
+						if (pass == 0)
+						{
+							sizes[p] += VECTOR_CODEC_POPCNT(mask);
+							continue;
+						}
+						for (; mask != 0; mask &= mask - 1)
+						{
+							*planes[p] = (uint8_t)(lanes[VECTOR_CODEC_CTZ(mask)] >> ((ProgressivePlanes - 1 - p) * 8));
+							++planes[p];
+						}
+					}
+				}
+				if (pass == 0)
+				{
+					planes[0] = (uint8_t*)headers + ((value_count + 7) & ~(size_t)7) / 2;
+					for (uint32_t p = 0; p != ProgressivePlanes; ++p)
+					{
+						VECTOR_CODEC_MEMCPY(out + p * 8, &sizes[p], 8);
+						if (p != 0)
+							planes[p] = planes[p - 1] + sizes[p - 1];
+					}
+				}
+			}
+			*(uint64_t*)planes[ProgressivePlanes - 1] = 0;
+			_mm256_zeroall();
+			return planes[ProgressivePlanes - 1] + 8 - out;
+		}
+
+		// Planes are consumed in whole blocks of 8 values. Once a block does not fit in the available prefix, that plane is lost for the
+		// rest of the array, since later values may be predicted from the missing bytes.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static uint32_t DecodeProgressive_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t value_count, size_t bytes_available, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const size_t header_size = ((value_count + 7) & ~(size_t)7) / 2;
+			VECTOR_CODEC_UNLIKELY_IF(bytes_available < ProgressivePrefixSize + header_size)
+			{
+				for (size_t i = 0; i != value_count; ++i)
+					out[i] = 0.0f;
+				return 0;
+			}
+			const uint32_t* in_headers = (const uint32_t*)(data + ProgressivePrefixSize);
+			const uint8_t* planes[ProgressivePlanes];
+			size_t remaining[ProgressivePlanes];
+			size_t offset = ProgressivePrefixSize + header_size;
+			uint32_t exact = ProgressivePlanes;
+			for (uint32_t p = 0; p != ProgressivePlanes; ++p)
+			{
+				uint64_t size;
+				VECTOR_CODEC_MEMCPY(&size, data + p * 8, 8);
+				planes[p] = data + offset;
+				remaining[p] = bytes_available > offset ? bytes_available - offset : 0;
+				if (remaining[p] > size)
+					remaining[p] = (size_t)size;
+				if (remaining[p] != size && exact == ProgressivePlanes)
+					exact = p;
+				offset += (size_t)size;
+			}
+			alignas(32) int32_t lookup[LookupSize] = {};
+			__m256i indices = _mm256_setzero_si256();
+			__m256i predicted = _mm256_setzero_si256();
+			uint32_t known = ProgressivePlanes;
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				const uint32_t header = VECTOR_CODEC_BSWAP_IF_BE(*in_headers);
+				++in_headers;
+				__m256i tzcounts, end;
+				ProgressiveCodes_AVX2(header, tzcounts, end);
+				__m256i residual = _mm256_setzero_si256();
+				for (uint32_t p = 0; p != known; ++p)
+				{
+					const uint32_t mask = ProgressiveMask_AVX2(tzcounts, end, ProgressivePlanes - 1 - p);
+					const uint32_t count = VECTOR_CODEC_POPCNT(mask);
+					VECTOR_CODEC_UNLIKELY_IF(count > remaining[p])
+					{
+						known = p;
+						break;
+					}
+					__m128i bytes;
+					VECTOR_CODEC_UNLIKELY_IF(remaining[p] < 8)
+					{
+						bytes = _mm_setzero_si128();
+						VECTOR_CODEC_MEMCPY(&bytes, planes[p], remaining[p]);
+					}
+					else
+						bytes = _mm_loadl_epi64((const __m128i*)planes[p]);
+					planes[p] += count;
+					remaining[p] -= count;
+					// Lane i takes the byte at the number of stored lanes below it, counted with a nibble popcount table.
+					const __m256i below = _mm256_and_si256(_mm256_set1_epi32((int32_t)mask), _mm256_set_epi32(127, 63, 31, 15, 7, 3, 1, 0));
+					const __m256i popcount = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+					const __m256i positions = _mm256_add_epi32(_mm256_shuffle_epi8(popcount, _mm256_and_si256(below, _mm256_set1_epi32(15))), _mm256_shuffle_epi8(popcount, _mm256_srli_epi32(below, 4)));
+					__m256i lanes = _mm256_permutevar8x32_epi32(_mm256_cvtepu8_epi32(bytes), positions);
+					const __m256i lane_bits = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+					lanes = _mm256_and_si256(lanes, _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int32_t)mask), lane_bits), lane_bits));
+					residual = _mm256_or_si256(residual, _mm256_slli_epi32(lanes, (int)(ProgressivePlanes - 1 - p) * 8));
+				}
+				__m256i vec = PredictBlock_AVX2<ISA>(lookup, indices, predicted, residual);
+				VECTOR_CODEC_UNLIKELY_IF(known != ProgressivePlanes)
+				{
+					// Keep the exact bytes and round the rest to the middle of their range.
+					if (known == 0)
+					{
+						vec = _mm256_setzero_si256();
+					}
+					else
+					{
+						const uint32_t lost_bits = (ProgressivePlanes - known) * 8;
+						vec = _mm256_and_si256(vec, _mm256_set1_epi32((int32_t)~((1U << lost_bits) - 1)));
+						vec = _mm256_or_si256(vec, _mm256_set1_epi32((int32_t)(1U << (lost_bits - 1))));
+					}
+				}
+				VECTOR_CODEC_UNLIKELY_IF(value_count - i < 8)
+					VECTOR_CODEC_MEMCPY(out + i, &vec, (value_count - i) << 2);
+				else
+					_mm256_storeu_si256((__m256i*)(out + i), vec);
+			}
+			_mm256_zeroall();
+			return known < exact ? known : exact;
+		}
+
+		constexpr size_t PlotBlockSize = 1024;
+
+		struct PlotNode
+		{
+			float min, max, first, last;
+		};
+
+		VECTOR_CODEC_INLINE_ALWAYS static
+		PlotNode PlotMerge(PlotNode left, PlotNode right) noexcept
+		{
+			left.min = right.min < left.min ? right.min : left.min;
+			left.max = right.max > left.max ? right.max : left.max;
+			left.last = right.last;
+			return left;
+		}
+
+		// Min and max skip NaN like ChunkStatistics: _mm256_min_ps and _mm256_max_ps return their second operand, the running value, when the first one is NaN.
+		VECTOR_CODEC_INLINE_ALWAYS static
+		PlotNode PlotAggregate_AVX2(const float* values, size_t value_count) noexcept
+		{
+			VECTOR_CODEC_INVARIANT(value_count != 0);
+			__m256 low = _mm256_set1_ps(INFINITY);
+			__m256 high = _mm256_set1_ps(-INFINITY);
+			size_t i = 0;
+			for (; i + 8 <= value_count; i += 8)
+			{
+				const __m256 vec = _mm256_loadu_ps(values + i);
+				low = _mm256_min_ps(vec, low);
+				high = _mm256_max_ps(vec, high);
+			}
+			alignas(32) float lows[8], highs[8];
+			_mm256_store_ps(lows, low);
+			_mm256_store_ps(highs, high);
+			PlotNode node = { INFINITY, -INFINITY, values[0], values[value_count - 1] };
+			for (uint32_t j = 0; j != 8; ++j)
+			{
+				node.min = lows[j] < node.min ? lows[j] : node.min;
+				node.max = highs[j] > node.max ? highs[j] : node.max;
+			}
+			for (; i != value_count; ++i)
+			{
+				node.min = values[i] < node.min ? values[i] : node.min;
+				node.max = values[i] > node.max ? values[i] : node.max;
+			}
+			return node;
+		}
+
+		// Layout: the value count, the end offset of every block, the blocks and the pyramid, finest level first. Level L has one node for
+		// every 2^L blocks, the last node of a level may cover fewer. The pyramid follows the blocks so that decoding the last block may read past it.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t EncodePlot_AVX2(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			const size_t blocks = (value_count + PlotBlockSize - 1) / PlotBlockSize;
+			const uint64_t count = value_count;
+			VECTOR_CODEC_MEMCPY(out, &count, 8);
+			uint8_t* const offsets = out + 8;
+			uint8_t* const streams = offsets + blocks * 8;
+			uint8_t* stream = streams;
+			PlotNode* const nodes = (PlotNode*)(out + UpperBoundPlot(value_count)) - blocks;
+			for (size_t i = 0; i != blocks; ++i)
+			{
+				const size_t n = value_count - i * PlotBlockSize < PlotBlockSize ? value_count - i * PlotBlockSize : PlotBlockSize;
+				stream += Encode_AVX2<ISA>(values + i * PlotBlockSize, n, stream);
+				const uint64_t offset = stream - streams;
+				VECTOR_CODEC_MEMCPY(offsets + i * 8, &offset, 8);
+				nodes[i] = PlotAggregate_AVX2(values + i * PlotBlockSize, n);
+			}
+			// The nodes were gathered at the end of the buffer, past the worst case end of the blocks. Move them right after the actual end.
+			uint8_t* pyramid = stream;
+			for (size_t i = 0; i != blocks; ++i)
+				((PlotNode*)pyramid)[i] = nodes[i];
+			for (size_t level = blocks; level > 1; level = (level + 1) / 2)
+			{
+				PlotNode* const finer = (PlotNode*)pyramid;
+				pyramid += level * sizeof(PlotNode);
+				PlotNode* const coarser = (PlotNode*)pyramid;
+				for (size_t i = 0; i < level; i += 2)
+					coarser[i / 2] = i + 1 != level ? PlotMerge(finer[i], finer[i + 1]) : finer[i];
+			}
+			_mm256_zeroall();
+			return pyramid + (blocks != 0 ? sizeof(PlotNode) : 0) - out;
+		}
+
+		// Each bucket is split into a partial block on each side, decoded once and kept while consecutive buckets share it, and a run of
+		// whole blocks covered by the largest aligned pyramid nodes that fit.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeForPlot_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t t0, size_t t1, size_t pixels, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			uint64_t count;
+			VECTOR_CODEC_MEMCPY(&count, data, 8);
+			const size_t value_count = (size_t)count;
+			VECTOR_CODEC_INVARIANT(t1 <= value_count);
+			const size_t blocks = (value_count + PlotBlockSize - 1) / PlotBlockSize;
+			const uint8_t* const offsets = data + 8;
+			const uint8_t* const streams = offsets + blocks * 8;
+			uint64_t end = 0;
+			if (blocks != 0)
+				VECTOR_CODEC_MEMCPY(&end, offsets + (blocks - 1) * 8, 8);
+			const PlotNode* const pyramid = (const PlotNode*)(streams + end);
+			alignas(32) float block[PlotBlockSize];
+			size_t cached = SIZE_MAX;
+			const auto aggregate = [&](size_t first, size_t last)
+			{
+				const size_t index = first / PlotBlockSize;
+				VECTOR_CODEC_UNLIKELY_IF(index != cached)
+				{
+					uint64_t begin = 0;
+					if (index != 0)
+						VECTOR_CODEC_MEMCPY(&begin, offsets + (index - 1) * 8, 8);
+					const size_t n = value_count - index * PlotBlockSize < PlotBlockSize ? value_count - index * PlotBlockSize : PlotBlockSize;
+					DecodeState_AVX2 state;
+					DecodeInit_AVX2(state, streams + begin, n, block);
+					DecodeFinish_AVX2<ISA>(state);
+					cached = index;
+				}
+				return PlotAggregate_AVX2(block + first % PlotBlockSize, last - first);
+			};
+			for (size_t p = 0; p != pixels; ++p)
+			{
+				const size_t first = t0 + (t1 - t0) * p / pixels;
+				const size_t last = t0 + (t1 - t0) * (p + 1) / pixels;
+				PlotNode node = { NAN, NAN, NAN, NAN };
+				VECTOR_CODEC_UNLIKELY_IF(first != last)
+				{
+					const size_t full_first = (first + PlotBlockSize - 1) / PlotBlockSize;
+					const size_t full_last = last / PlotBlockSize;
+					bool empty = true;
+					const auto merge = [&](PlotNode next)
+					{
+						node = empty ? next : PlotMerge(node, next);
+						empty = false;
+					};
+					if (first < full_first * PlotBlockSize)
+						merge(aggregate(first, last < full_first * PlotBlockSize ? last : full_first * PlotBlockSize));
+					for (size_t position = full_first; position < full_last;)
+					{
+						size_t level = 0;
+						size_t level_begin = 0;
+						size_t level_size = blocks;
+						for (;;)
+						{
+							const size_t span = (size_t)2 << level;
+							const size_t span_end = position + span < blocks ? position + span : blocks;
+							if (level_size <= 1 || position % span != 0 || span_end > full_last)
+								break;
+							level_begin += level_size;
+							level_size = (level_size + 1) / 2;
+							++level;
+						}
+						merge(pyramid[level_begin + (position >> level)]);
+						position += (size_t)1 << level;
+					}
+					if (full_last >= full_first && full_last * PlotBlockSize < last)
+						merge(aggregate(full_last * PlotBlockSize, last));
+				}
+				out[p * 4] = node.min;
+				out[p * 4 + 1] = node.max;
+				out[p * 4 + 2] = node.first;
+				out[p * 4 + 3] = node.last;
+			}
+			_mm256_zeroall();
+		}
+
+		static_assert(AppendFooterSize == LookupSize * 4 + sizeof(__m256i) * 2 + 16, "AppendFooterSize must match the predictor state.");
+
+		struct AppendFooter
+		{
+			int32_t lookup[LookupSize];
+			__m256i indices, predicted;
+			uint64_t value_count, segment_count;
+		};
+
+		// Layout: segments made of a 64-bit value count and an Encode stream that continues the predictor state of the previous segment,
+		// then the footer. A partial last block is padded with zeros, which the decoder reproduces, so the state stays in sync.
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static size_t Append_AVX2(AppendStream& stream, const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+		{
+			VECTOR_CODEC_UNLIKELY_IF(value_count == 0)
+				return stream.size;
+			alignas(64) AppendFooter footer;
+			uint8_t* out = stream.data + stream.size - AppendFooterSize;
+			VECTOR_CODEC_MEMCPY(&footer, out, AppendFooterSize);
+			const uint64_t count = value_count;
+			VECTOR_CODEC_MEMCPY(out, &count, 8);
+			out += 8;
+			uint32_t* out_headers = (uint32_t*)out;
+			out += ((value_count + 7) & ~(size_t)7) / 2;
+			for (size_t i = 0; i < value_count; i += 8)
+			{
+				__m256i vec = _mm256_setzero_si256();
+				const size_t n = value_count - i;
+				VECTOR_CODEC_UNLIKELY_IF(n < 8)
+					VECTOR_CODEC_MEMCPY(&vec, values + i, n << 2);
+				else
+					vec = _mm256_loadu_si256((const __m256i*)(values + i));
+				*out_headers = VECTOR_CODEC_BSWAP_IF_BE(EncodeBlock_AVX2<ISA>(footer.lookup, footer.indices, footer.predicted, vec, out));
+				++out_headers;
+			}
+			footer.value_count += value_count;
+			++footer.segment_count;
+			VECTOR_CODEC_MEMCPY(out, &footer, AppendFooterSize);
+			_mm256_zeroall();
+			stream.size = out + AppendFooterSize - stream.data;
+			stream.value_count = (size_t)footer.value_count;
+			return stream.size;
+		}
+
+		template <typename ISA>
+		VECTOR_CODEC_INLINE_ALWAYS
+		static void DecodeAppendable_AVX2(const uint8_t* VECTOR_CODEC_RESTRICT data, size_t size, float* VECTOR_CODEC_RESTRICT out) noexcept
+		{
+			uint64_t segment_count;
+			VECTOR_CODEC_MEMCPY(&segment_count, data + size - 8, 8);
+			DecodeState_AVX2 state;
+			DecodeInit_AVX2(state, data, 0, out);
+			for (uint64_t i = 0; i != segment_count; ++i)
+			{
+				uint64_t count;
+				VECTOR_CODEC_MEMCPY(&count, data, 8);
+				data += 8;
+				state.in_headers = (const uint32_t*)data;
+				state.data = data + ((count + 7) & ~(uint64_t)7) / 2;
+				state.value_count = (size_t)count;
+				DecodeFinish_AVX2<ISA>(state);
+				data = state.data;
+				out += count;
+				state.out = out;
+			}
+			_mm256_zeroall();
+		}
+
+		constexpr uint32_t ArchiveMagic = 0x31414356;
+		constexpr size_t ArchiveFooterSize = 32;
+		constexpr size_t ArchiveMinRecordSize = 4 + 1 + 4 + 4 + 24;
+
+		constexpr uint32_t TableMagic = 0x31544356;
+		constexpr size_t TableFooterSize = 24;
+		constexpr size_t TableHeaderSize = 24;
+		constexpr size_t TableChunkRecordSize = 36;
+
+		constexpr uint32_t LogManifestMagic = 0x314D4356;
+		constexpr uint32_t LogSegmentMagic = 0x31534356;
+		constexpr size_t LogRecordHeaderSize = 12;
+		constexpr size_t LogIndexRecordSize = 24;
+		constexpr size_t LogFooterSize = 24;
+		constexpr size_t LogDecodePadding = 64;
+
+		// Min and max skip NaN because _mm256_min_ps and _mm256_max_ps return their second operand when either one is NaN.
+		static void ChunkStatistics(const float* values, size_t value_count, ColumnChunk& chunk) noexcept
+		{
+			__m256 low = _mm256_set1_ps(INFINITY);
+			__m256 high = _mm256_set1_ps(-INFINITY);
+			uint64_t nan_count = 0;
+			size_t i = 0;
+			for (; i + 8 <= value_count; i += 8)
+			{
+				const __m256 v = _mm256_loadu_ps(values + i);
+				low = _mm256_min_ps(v, low);
+				high = _mm256_max_ps(v, high);
+				nan_count += VECTOR_CODEC_POPCNT((uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+			}
+			alignas(32) float lows[8], highs[8];
+			_mm256_store_ps(lows, low);
+			_mm256_store_ps(highs, high);
+			float min = INFINITY, max = -INFINITY;
+			for (size_t j = 0; j != 8; ++j)
+			{
+				min = lows[j] < min ? lows[j] : min;
+				max = highs[j] > max ? highs[j] : max;
+			}
+			for (; i != value_count; ++i)
+			{
+				const float v = values[i];
+				nan_count += v != v;
+				min = v < min ? v : min;
+				max = v > max ? v : max;
+			}
+			chunk.min = min;
+			chunk.max = max;
+			chunk.nan_count = nan_count;
+		}
+
+		// CRC32C with the SSE4.2 instruction, which every CPU with AVX2 has. Passing the checksum of some bytes as previous extends it
+		// to the bytes that follow them.
+		static uint32_t Checksum(const uint8_t* data, size_t size, uint32_t previous = 0) noexcept
+		{
+			uint64_t crc = previous ^ 0xFFFFFFFF;
+			for (; size >= 8; size -= 8, data += 8)
+			{
+				uint64_t word;
+				VECTOR_CODEC_MEMCPY(&word, data, 8);
+				crc = _mm_crc32_u64(crc, word);
+			}
+			for (; size != 0; --size, ++data)
+				crc = _mm_crc32_u8((uint32_t)crc, *data);
+			return (uint32_t)crc ^ 0xFFFFFFFF;
+		}
+
+		// Maps a whole file read-only. The mapping handle is only used on Windows.
+		static bool MapFile(const char* path, const uint8_t*& base, size_t& size, void*& mapping) noexcept
+		{
+#ifdef _WIN32
+			HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			VECTOR_CODEC_UNLIKELY_IF(file == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER file_size;
+			HANDLE handle = GetFileSizeEx(file, &file_size) && file_size.QuadPart != 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+			CloseHandle(file);
+			VECTOR_CODEC_UNLIKELY_IF(handle == nullptr)
+				return false;
+			const void* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+			VECTOR_CODEC_UNLIKELY_IF(view == nullptr)
+			{
+				CloseHandle(handle);
+				return false;
+			}
+			base = (const uint8_t*)view;
+			size = (size_t)file_size.QuadPart;
+			mapping = handle;
+#else
+			const int fd = open(path, O_RDONLY | O_CLOEXEC);
+			VECTOR_CODEC_UNLIKELY_IF(fd < 0)
+				return false;
+			struct stat info;
+			void* const view = fstat(fd, &info) == 0 && info.st_size != 0 ? mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+			close(fd);
+			VECTOR_CODEC_UNLIKELY_IF(view == MAP_FAILED)
+				return false;
+			base = (const uint8_t*)view;
+			size = (size_t)info.st_size;
+			mapping = nullptr;
+#endif
+			return true;
+		}
+
+		static void UnmapFile(const uint8_t* base, size_t size, void* mapping) noexcept
+		{
+#ifdef _WIN32
+			(void)size;
+			UnmapViewOfFile(base);
+			CloseHandle(mapping);
+#else
+			(void)mapping;
+			munmap((void*)base, size);
+#endif
+		}
+
+		// Replaces to with from, atomically on POSIX file systems.
+		static bool RenameFile(const char* from, const char* to) noexcept
+		{
+#ifdef _WIN32
+			return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+			return std::rename(from, to) == 0;
+#endif
+		}
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL Encode(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::Encode_AVX2<decltype(isa)>(values, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL Decode(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::Dispatch([&](auto isa) { Impl::Decode_AVX2<decltype(isa)>(compressed, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeQuick(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodeQuick_AVX2<decltype(isa)>(values, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeQuick(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::Dispatch([&](auto isa) { Impl::DecodeQuick_AVX2<decltype(isa)>(compressed, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeMany(const uint8_t* const* compressed, const size_t* value_counts, float* const* out, size_t stream_count) noexcept
+	{
+		Impl::Dispatch([&](auto isa) { Impl::DecodeMany_AVX2<decltype(isa)>(compressed, value_counts, out, stream_count); });
+	}
+
+	template <size_t N>
+	VECTOR_CODEC_INLINE_ALWAYS
+	size_t VECTOR_CODEC_CALL Encode(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodeFixed_AVX2<decltype(isa), N>(values, out); });
+	}
+
+	template <size_t N>
+	VECTOR_CODEC_INLINE_ALWAYS
+	void VECTOR_CODEC_CALL Decode(const uint8_t* VECTOR_CODEC_RESTRICT compressed, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::Dispatch([&](auto isa) { Impl::DecodeFixed_AVX2<decltype(isa), N>(compressed, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeCompact(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodeCompact_AVX2<decltype(isa)>(values, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeCompact(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::Dispatch([&](auto isa) { Impl::DecodeCompact_AVX2<decltype(isa)>(compressed, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeChimp(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodeChimp_AVX2<decltype(isa)>(values, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeChimp(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::Dispatch([&](auto isa) { Impl::DecodeChimp_AVX2<decltype(isa)>(compressed, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeALP(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::EncodeALP_AVX2(values, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeALP(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::DecodeALP_AVX2(compressed, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeDictionary(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::EncodeDictionary_AVX2(values, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeDictionary(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::DecodeDictionary_AVX2(compressed, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeRLE(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::EncodeRLE_AVX2(values, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeRLE(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::DecodeRLE_AVX2(compressed, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeDowncast(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::EncodeDowncast_AVX2(values, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeDowncast(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Impl::DecodeDowncast_AVX2(compressed, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeAuto(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		Format format = Impl::ChooseFormat(values, value_count);
+		*out = (uint8_t)format;
+		VECTOR_CODEC_UNLIKELY_IF(value_count == 0)
+			return 1;
+		const size_t k = Impl::EncodeFormat(format, values, value_count, out + 1);
+		return k != 0 ? k + 1 : 0;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeAuto(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		VECTOR_CODEC_UNLIKELY_IF(value_count == 0)
+			return;
+		Impl::DecodeFormat((Format)*compressed, compressed + 1, value_count, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL Transcode(Format source_format, Format target_format, const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::Transcode_AVX2<decltype(isa)>(source_format, target_format, compressed, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeFixedRate(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint32_t rate, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		VECTOR_CODEC_INVARIANT(rate >= 1 && rate <= 32);
+		return Impl::EncodeFixedRate_AVX2(values, value_count, rate, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeFixedRate(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, uint32_t rate, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		VECTOR_CODEC_INVARIANT(rate >= 1 && rate <= 32);
+		Impl::DecodeFixedRate_AVX2(compressed, value_count, rate, out);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeBlock(const uint8_t* VECTOR_CODEC_RESTRICT compressed, uint32_t rate, size_t block_index, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		VECTOR_CODEC_INVARIANT(rate >= 1 && rate <= 32);
+		Impl::DecodeFixedRateBlock_AVX2(compressed + block_index * rate * 2, rate * (uint32_t)Impl::FixedRateBlockSize, out);
+		_mm256_zeroall();
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeToBudget(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, size_t target_bytes, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodeToBudget_AVX2<decltype(isa)>(values, value_count, target_bytes, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodeProgressive(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodeProgressive_AVX2<decltype(isa)>(values, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	uint32_t VECTOR_CODEC_CALL DecodeProgressive(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, size_t bytes_available, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::DecodeProgressive_AVX2<decltype(isa)>(compressed, value_count, bytes_available, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL EncodePlot(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::EncodePlot_AVX2<decltype(isa)>(values, value_count, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeForPlot(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t t0, size_t t1, size_t pixels, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		VECTOR_CODEC_INVARIANT(t0 <= t1);
+		Impl::Dispatch([&](auto isa) { Impl::DecodeForPlot_AVX2<decltype(isa)>(compressed, t0, t1, pixels, out); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	AppendStream VECTOR_CODEC_CALL OpenForAppend(uint8_t* compressed, size_t compressed_size) noexcept
+	{
+		VECTOR_CODEC_UNLIKELY_IF(compressed_size == 0)
+		{
+			std::memset(compressed, 0, AppendFooterSize);
+			return { compressed, AppendFooterSize, 0 };
+		}
+		VECTOR_CODEC_INVARIANT(compressed_size >= AppendFooterSize);
+		uint64_t value_count;
+		VECTOR_CODEC_MEMCPY(&value_count, compressed + compressed_size - 16, 8);
+		return { compressed, compressed_size, (size_t)value_count };
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t VECTOR_CODEC_CALL Append(AppendStream& stream, const float* VECTOR_CODEC_RESTRICT values, size_t value_count) noexcept
+	{
+		return Impl::Dispatch([&](auto isa) { return Impl::Append_AVX2<decltype(isa)>(stream, values, value_count); });
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void VECTOR_CODEC_CALL DecodeAppendable(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t compressed_size, float* VECTOR_CODEC_RESTRICT out) noexcept
+	{
+		VECTOR_CODEC_INVARIANT(compressed_size >= AppendFooterSize);
+		Impl::Dispatch([&](auto isa) { Impl::DecodeAppendable_AVX2<decltype(isa)>(compressed, compressed_size, out); });
+	}
+
+#ifdef __linux__
+	// The handler thread owns the fault units: it is the only one that populates or drops them, so the FIFO of resident units needs no lock.
+	struct DecompressedMapping::State
+	{
+		const void* context = nullptr;
+		DecodeRange decode = nullptr;
+		size_t value_count = 0;
+		uint8_t* region = nullptr;
+		size_t region_size = 0;
+		float* buffer = nullptr;
+		int fault_fd = -1;
+		int stop_fd = -1;
+		std::vector<size_t> resident;
+		size_t oldest = 0;
+		size_t resident_count = 0;
+		std::thread handler;
+
+		~State()
+		{
+			if (handler.joinable())
+			{
+				const uint64_t one = 1;
+				(void)!write(stop_fd, &one, sizeof(one));
+				handler.join();
+			}
+			if (region != nullptr)
+				munmap(region, region_size);
+			if (buffer != nullptr)
+				munmap(buffer, fault_size);
+			if (fault_fd >= 0)
+				close(fault_fd);
+			if (stop_fd >= 0)
+				close(stop_fd);
+		}
+
+		void Fill(size_t unit) noexcept
+		{
+			const size_t unit_values = fault_size / sizeof(float);
+			const size_t first = unit * unit_values;
+			const size_t count = first < value_count ? (value_count - first < unit_values ? value_count - first : unit_values) : 0;
+			decode(context, first, count, buffer);
+			std::memset(buffer + count, 0, (unit_values - count) * sizeof(float));
+			uffdio_copy copy = {};
+			copy.dst = (uintptr_t)(region + unit * fault_size);
+			copy.src = (uintptr_t)buffer;
+			copy.len = fault_size;
+			VECTOR_CODEC_UNLIKELY_IF(ioctl(fault_fd, UFFDIO_COPY, &copy) != 0)
+			{
+				// Several threads touched the unit before it was populated: the first fault filled it, the others only need waking.
+				uffdio_range range = { copy.dst, fault_size };
+				(void)ioctl(fault_fd, UFFDIO_WAKE, &range);
+				return;
+			}
+			if (resident.empty())
+				return;
+			if (resident_count == resident.size())
+			{
+				(void)madvise(region + resident[oldest] * fault_size, fault_size, MADV_DONTNEED);
+				resident[oldest] = unit;
+				oldest = (oldest + 1) % resident.size();
+				return;
+			}
+			resident[resident_count++] = unit;
+		}
+
+		void Run() noexcept
+		{
+			for (;;)
+			{
+				pollfd fds[2] = { { fault_fd, POLLIN, 0 }, { stop_fd, POLLIN, 0 } };
+				VECTOR_CODEC_UNLIKELY_IF(poll(fds, 2, -1) < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return;
+				}
+				if (fds[1].revents != 0)
+					return;
+				uffd_msg message;
+				if (read(fault_fd, &message, sizeof(message)) != (ssize_t)sizeof(message) || message.event != UFFD_EVENT_PAGEFAULT)
+					continue;
+				Fill((size_t)(message.arg.pagefault.address - (uintptr_t)region) / fault_size);
+			}
+		}
+	};
+#else
+	struct DecompressedMapping::State
+	{
+		uint8_t* region = nullptr;
+		size_t value_count = 0;
+	};
+#endif
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	DecompressedMapping DecompressedMapping::Map(const void* context, size_t value_count, DecodeRange decode, size_t resident_bytes)
+	{
+		DecompressedMapping r;
+#ifdef __linux__
+		VECTOR_CODEC_UNLIKELY_IF(value_count == 0)
+			return r;
+		auto state = std::unique_ptr<State>(new State());
+		state->context = context;
+		state->decode = decode;
+		state->value_count = value_count;
+		state->region_size = (value_count * sizeof(float) + fault_size - 1) / fault_size * fault_size;
+		if (resident_bytes != 0)
+			state->resident.resize((resident_bytes + fault_size - 1) / fault_size);
+		// Kernels that restrict userfaultfd to privileged users still allow it for faults raised from user mode. That mode is only a fallback,
+		// since faults raised by the kernel on behalf of a system call are then not served.
+		state->fault_fd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+#ifdef UFFD_USER_MODE_ONLY
+		if (state->fault_fd < 0)
+			state->fault_fd = (int)syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+#endif
+		VECTOR_CODEC_UNLIKELY_IF(state->fault_fd < 0)
+			return r;
+		uffdio_api api = {};
+		api.api = UFFD_API;
+		VECTOR_CODEC_UNLIKELY_IF(ioctl(state->fault_fd, UFFDIO_API, &api) != 0)
+			return r;
+		state->stop_fd = eventfd(0, EFD_CLOEXEC);
+		void* const region = mmap(nullptr, state->region_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		void* const buffer = mmap(nullptr, fault_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		state->region = region != MAP_FAILED ? (uint8_t*)region : nullptr;
+		state->buffer = buffer != MAP_FAILED ? (float*)buffer : nullptr;
+		VECTOR_CODEC_UNLIKELY_IF(state->stop_fd < 0 || state->region == nullptr || state->buffer == nullptr)
+			return r;
+		uffdio_register registration = {};
+		registration.range.start = (uintptr_t)state->region;
+		registration.range.len = state->region_size;
+		registration.mode = UFFDIO_REGISTER_MODE_MISSING;
+		VECTOR_CODEC_UNLIKELY_IF(ioctl(state->fault_fd, UFFDIO_REGISTER, &registration) != 0)
+			return r;
+		State* const handler_state = state.get();
+		state->handler = std::thread([handler_state] { handler_state->Run(); });
+		r.state = std::move(state);
+#else
+		(void)context;
+		(void)value_count;
+		(void)decode;
+		(void)resident_bytes;
+#endif
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	DecompressedMapping& DecompressedMapping::operator=(DecompressedMapping&& other) noexcept
+	{
+		state = std::move(other.state);
+		return *this;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	DecompressedMapping::~DecompressedMapping() = default;
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	const float* DecompressedMapping::data() const noexcept
+	{
+		return state != nullptr ? (const float*)state->region : nullptr;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t DecompressedMapping::size() const noexcept
+	{
+		return state != nullptr ? state->value_count : 0;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool ArchiveWriter::Open(const char* path) noexcept
+	{
+		(void)Close();
+		file = std::fopen(path, "wb");
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr)
+			return false;
+		const uint32_t magic = Impl::ArchiveMagic;
+		failed = std::fwrite(&magic, 4, 1, file) != 1;
+		offset = 4;
+		count = 0;
+		index.clear();
+		return !failed;
+	}
+
+	// Index record: the name length, the name and a null terminator, the type, the codec, the rank, a reserved byte, the checksum, then
+	// the offset, the size and the value count as 64-bit integers, followed by the shape.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool ArchiveWriter::Add(const char* name, const float* values, const uint64_t* shape, uint32_t rank)
+	{
+		VECTOR_CODEC_INVARIANT(rank <= ArchiveMaxRank);
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr || failed)
+			return false;
+		uint64_t value_count = 1;
+		for (uint32_t i = 0; i != rank; ++i)
+			value_count *= shape[i];
+		buffer.resize(UpperBoundAuto((size_t)value_count));
+		const size_t k = EncodeAuto(values, (size_t)value_count, buffer.data());
+		VECTOR_CODEC_UNLIKELY_IF(k == 0)
+			return false;
+		const uint64_t size = k - 1;
+		VECTOR_CODEC_UNLIKELY_IF(size != 0 && std::fwrite(buffer.data() + 1, 1, (size_t)size, file) != size)
+		{
+			failed = true;
+			return false;
+		}
+		const auto put = [&](const void* data, size_t n)
+		{
+			index.insert(index.end(), (const uint8_t*)data, (const uint8_t*)data + n);
+		};
+		const uint32_t name_length = (uint32_t)std::strlen(name);
+		const uint8_t attributes[4] = { (uint8_t)DataType::Float32, buffer[0], (uint8_t)rank, 0 };
+		const uint32_t checksum = Impl::Checksum(buffer.data() + 1, (size_t)size);
+		put(&name_length, 4);
+		put(name, name_length + 1);
+		put(attributes, 4);
+		put(&checksum, 4);
+		put(&offset, 8);
+		put(&size, 8);
+		put(&value_count, 8);
+		put(shape, rank * 8);
+		offset += size;
+		++count;
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool ArchiveWriter::Close() noexcept
+	{
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr)
+			return true;
+		uint8_t footer[Impl::ArchiveFooterSize];
+		const uint64_t index_size = index.size();
+		const uint32_t checksum = Impl::Checksum(index.data(), index.size());
+		const uint32_t magic = Impl::ArchiveMagic;
+		VECTOR_CODEC_MEMCPY(footer, &offset, 8);
+		VECTOR_CODEC_MEMCPY(footer + 8, &index_size, 8);
+		VECTOR_CODEC_MEMCPY(footer + 16, &count, 8);
+		VECTOR_CODEC_MEMCPY(footer + 24, &checksum, 4);
+		VECTOR_CODEC_MEMCPY(footer + 28, &magic, 4);
+		if (!index.empty() && std::fwrite(index.data(), 1, index.size(), file) != index.size())
+			failed = true;
+		if (std::fwrite(footer, 1, sizeof(footer), file) != sizeof(footer))
+			failed = true;
+		if (std::fclose(file) != 0)
+			failed = true;
+		file = nullptr;
+		index.clear();
+		return !failed;
+	}
+
+	// Every field of the index is validated against the size of the file, and the value count of each entry against its shape and the
+	// fewest bytes its codec needs for that many values, so a truncated or corrupt archive fails to open instead of being read out of bounds.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	Archive Archive::Open(const char* path)
+	{
+		Archive r;
+		VECTOR_CODEC_UNLIKELY_IF(!Impl::MapFile(path, r.base, r.size, r.mapping))
+			return r;
+		uint64_t index_offset = 0, index_size = 0, count = 0;
+		uint32_t checksum = 0, magic = 0, head = 0;
+		bool valid = r.size >= 4 + Impl::ArchiveFooterSize;
+		if (valid)
+		{
+			const uint8_t* const footer = r.base + r.size - Impl::ArchiveFooterSize;
+			VECTOR_CODEC_MEMCPY(&index_offset, footer, 8);
+			VECTOR_CODEC_MEMCPY(&index_size, footer + 8, 8);
+			VECTOR_CODEC_MEMCPY(&count, footer + 16, 8);
+			VECTOR_CODEC_MEMCPY(&checksum, footer + 24, 4);
+			VECTOR_CODEC_MEMCPY(&magic, footer + 28, 4);
+			VECTOR_CODEC_MEMCPY(&head, r.base, 4);
+			const uint64_t limit = r.size - Impl::ArchiveFooterSize;
+			valid = head == Impl::ArchiveMagic && magic == Impl::ArchiveMagic && index_offset >= 4 && index_offset <= limit && index_size <= limit - index_offset &&
+				count <= index_size / Impl::ArchiveMinRecordSize && Impl::Checksum(r.base + index_offset, (size_t)index_size) == checksum;
+		}
+		if (valid)
+			r.entries.reserve((size_t)count);
+		const uint8_t* cursor = r.base + index_offset;
+		const uint8_t* const end = cursor + index_size;
+		for (uint64_t i = 0; i != count && valid; ++i)
+		{
+			ArchiveEntry entry = {};
+			uint32_t name_length;
+			valid = end - cursor >= 4;
+			if (valid)
+			{
+				VECTOR_CODEC_MEMCPY(&name_length, cursor, 4);
+				cursor += 4;
+				valid = (uint64_t)(end - cursor) >= (uint64_t)name_length + Impl::ArchiveMinRecordSize - 4 && cursor[name_length] == 0;
+			}
+			if (valid)
+			{
+				entry.name = (const char*)cursor;
+				cursor += name_length + 1;
+				entry.type = (DataType)cursor[0];
+				entry.codec = (Format)cursor[1];
+				entry.rank = cursor[2];
+				VECTOR_CODEC_MEMCPY(&entry.checksum, cursor + 4, 4);
+				VECTOR_CODEC_MEMCPY(&entry.offset, cursor + 8, 8);
+				VECTOR_CODEC_MEMCPY(&entry.size, cursor + 16, 8);
+				VECTOR_CODEC_MEMCPY(&entry.value_count, cursor + 24, 8);
+				cursor += 32;
+				valid = entry.type == DataType::Float32 && entry.codec <= Format::Downcast && entry.rank <= ArchiveMaxRank && (size_t)(end - cursor) >= entry.rank * 8 &&
+					entry.offset >= 4 && entry.offset <= index_offset && entry.size <= index_offset - entry.offset;
+			}
+			if (valid)
+			{
+				VECTOR_CODEC_MEMCPY(entry.shape, cursor, entry.rank * 8);
+				cursor += entry.rank * 8;
+				uint64_t product = 1;
+				for (uint32_t j = 0; j != entry.rank && valid; ++j)
+				{
+					valid = entry.shape[j] == 0 || product <= UINT64_MAX / entry.shape[j];
+					product *= entry.shape[j];
+				}
+				valid = valid && entry.value_count == product && entry.value_count <= SIZE_MAX / 4 &&
+					entry.size >= Impl::MinimumSize(entry.codec, (size_t)entry.value_count);
+				r.entries.push_back(entry);
+			}
+		}
+		VECTOR_CODEC_UNLIKELY_IF(!valid)
+		{
+			r.Close();
+			return r;
+		}
+		std::sort(r.entries.begin(), r.entries.end(), [](const ArchiveEntry& left, const ArchiveEntry& right) { return std::strcmp(left.name, right.name) < 0; });
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	const ArchiveEntry* Archive::Find(const char* name) const noexcept
+	{
+		const auto it = std::lower_bound(entries.begin(), entries.end(), name, [](const ArchiveEntry& entry, const char* key) { return std::strcmp(entry.name, key) < 0; });
+		VECTOR_CODEC_UNLIKELY_IF(it == entries.end() || std::strcmp(it->name, name) != 0)
+			return nullptr;
+		return &*it;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool Archive::Read(const ArchiveEntry& entry, float* out) const noexcept
+	{
+		VECTOR_CODEC_UNLIKELY_IF(Impl::Checksum(base + entry.offset, (size_t)entry.size) != entry.checksum)
+			return false;
+		VECTOR_CODEC_UNLIKELY_IF(entry.value_count == 0)
+			return true;
+		Impl::DecodeFormat(entry.codec, base + entry.offset, (size_t)entry.value_count, out);
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void Archive::Close() noexcept
+	{
+		if (base != nullptr)
+			Impl::UnmapFile(base, size, mapping);
+		base = nullptr;
+		size = 0;
+		mapping = nullptr;
+		entries.clear();
+	}
+
+	// The file starts with the magic number, followed by the chunks of each row group in column order.
+	// Metadata: the column count, a reserved word, the rows per group and the row count, then each column name as its length, the name and a null terminator,
+	// then a record per chunk in row group order: offset, size, NaN count, min, max and checksum.
+	// Footer: the metadata offset and size, its checksum and the magic number.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool TableWriter::Open(const char* path, const char* const* column_names, uint32_t column_count, size_t rows_per_group, const Format* formats)
+	{
+		VECTOR_CODEC_INVARIANT(column_count != 0 && rows_per_group != 0);
+		(void)Close();
+		file = std::fopen(path, "wb");
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr)
+			return false;
+		const uint32_t magic = Impl::TableMagic;
+		failed = std::fwrite(&magic, 4, 1, file) != 1;
+		offset = 4;
+		row_count = 0;
+		pending_rows = 0;
+		this->rows_per_group = rows_per_group;
+		this->column_count = column_count;
+		this->formats.clear();
+		if (formats != nullptr)
+			this->formats.assign(formats, formats + column_count);
+		names.clear();
+		for (uint32_t i = 0; i != column_count; ++i)
+		{
+			const uint32_t name_length = (uint32_t)std::strlen(column_names[i]);
+			names.insert(names.end(), (const uint8_t*)&name_length, (const uint8_t*)&name_length + 4);
+			names.insert(names.end(), (const uint8_t*)column_names[i], (const uint8_t*)column_names[i] + name_length + 1);
+		}
+		chunks.clear();
+		pending.resize((size_t)column_count * rows_per_group);
+		return !failed;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool TableWriter::Append(const float* const* columns, size_t row_count)
+	{
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr || failed)
+			return false;
+		for (size_t done = 0; done != row_count;)
+		{
+			size_t n = rows_per_group - pending_rows;
+			if (n > row_count - done)
+				n = row_count - done;
+			for (uint32_t i = 0; i != column_count; ++i)
+				VECTOR_CODEC_MEMCPY(pending.data() + (size_t)i * rows_per_group + pending_rows, columns[i] + done, n * 4);
+			pending_rows += n;
+			done += n;
+			VECTOR_CODEC_UNLIKELY_IF(pending_rows == rows_per_group && !Flush())
+				return false;
+		}
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool TableWriter::Flush()
+	{
+		buffer.resize(UpperBoundAuto(pending_rows));
+		for (uint32_t i = 0; i != column_count; ++i)
+		{
+			const float* const values = pending.data() + (size_t)i * rows_per_group;
+			size_t k = 0;
+			if (!formats.empty())
+			{
+				buffer[0] = (uint8_t)formats[i];
+				k = Impl::EncodeFormat(formats[i], values, pending_rows, buffer.data() + 1);
+				k += k != 0;
+			}
+			if (k == 0)
+				k = EncodeAuto(values, pending_rows, buffer.data());
+			VECTOR_CODEC_UNLIKELY_IF(k == 0 || std::fwrite(buffer.data(), 1, k, file) != k)
+			{
+				failed = true;
+				return false;
+			}
+			ColumnChunk chunk;
+			Impl::ChunkStatistics(values, pending_rows, chunk);
+			const uint64_t size = k;
+			const uint32_t checksum = Impl::Checksum(buffer.data(), k);
+			uint8_t record[Impl::TableChunkRecordSize];
+			VECTOR_CODEC_MEMCPY(record, &offset, 8);
+			VECTOR_CODEC_MEMCPY(record + 8, &size, 8);
+			VECTOR_CODEC_MEMCPY(record + 16, &chunk.nan_count, 8);
+			VECTOR_CODEC_MEMCPY(record + 24, &chunk.min, 4);
+			VECTOR_CODEC_MEMCPY(record + 28, &chunk.max, 4);
+			VECTOR_CODEC_MEMCPY(record + 32, &checksum, 4);
+			chunks.insert(chunks.end(), record, record + sizeof(record));
+			offset += size;
+		}
+		row_count += pending_rows;
+		pending_rows = 0;
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool TableWriter::Close() noexcept
+	{
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr)
+			return true;
+		if (!failed && pending_rows != 0)
+			(void)Flush();
+		uint8_t header[Impl::TableHeaderSize] = {};
+		VECTOR_CODEC_MEMCPY(header, &column_count, 4);
+		const uint64_t group_size = rows_per_group;
+		VECTOR_CODEC_MEMCPY(header + 8, &group_size, 8);
+		VECTOR_CODEC_MEMCPY(header + 16, &row_count, 8);
+		std::vector<uint8_t> metadata;
+		metadata.reserve(sizeof(header) + names.size() + chunks.size());
+		metadata.insert(metadata.end(), header, header + sizeof(header));
+		metadata.insert(metadata.end(), names.begin(), names.end());
+		metadata.insert(metadata.end(), chunks.begin(), chunks.end());
+		uint8_t footer[Impl::TableFooterSize];
+		const uint64_t metadata_size = metadata.size();
+		const uint32_t checksum = Impl::Checksum(metadata.data(), metadata.size());
+		const uint32_t magic = Impl::TableMagic;
+		VECTOR_CODEC_MEMCPY(footer, &offset, 8);
+		VECTOR_CODEC_MEMCPY(footer + 8, &metadata_size, 8);
+		VECTOR_CODEC_MEMCPY(footer + 16, &checksum, 4);
+		VECTOR_CODEC_MEMCPY(footer + 20, &magic, 4);
+		if (std::fwrite(metadata.data(), 1, metadata.size(), file) != metadata.size())
+			failed = true;
+		if (std::fwrite(footer, 1, sizeof(footer), file) != sizeof(footer))
+			failed = true;
+		if (std::fclose(file) != 0)
+			failed = true;
+		file = nullptr;
+		names.clear();
+		chunks.clear();
+		pending.clear();
+		return !failed;
+	}
+
+	// Like Archive::Open, every field of the metadata is validated against the size of the file, and every chunk must be large enough for
+	// the rows of its group in its codec. A group size above the row count is cut down to it, so that Scan only allocates for rows that exist.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	Table Table::Open(const char* path)
+	{
+		Table r;
+		VECTOR_CODEC_UNLIKELY_IF(!Impl::MapFile(path, r.base, r.size, r.mapping))
+			return r;
+		uint64_t metadata_offset = 0, metadata_size = 0;
+		uint32_t checksum = 0, magic = 0, head = 0;
+		bool valid = r.size >= 4 + Impl::TableFooterSize;
+		if (valid)
+		{
+			const uint8_t* const footer = r.base + r.size - Impl::TableFooterSize;
+			VECTOR_CODEC_MEMCPY(&metadata_offset, footer, 8);
+			VECTOR_CODEC_MEMCPY(&metadata_size, footer + 8, 8);
+			VECTOR_CODEC_MEMCPY(&checksum, footer + 16, 4);
+			VECTOR_CODEC_MEMCPY(&magic, footer + 20, 4);
+			VECTOR_CODEC_MEMCPY(&head, r.base, 4);
+			const uint64_t limit = r.size - Impl::TableFooterSize;
+			valid = head == Impl::TableMagic && magic == Impl::TableMagic && metadata_offset >= 4 && metadata_offset <= limit &&
+				metadata_size >= Impl::TableHeaderSize && metadata_size <= limit - metadata_offset &&
+				Impl::Checksum(r.base + metadata_offset, (size_t)metadata_size) == checksum;
+		}
+		const uint8_t* cursor = r.base + metadata_offset;
+		const uint8_t* const end = cursor + metadata_size;
+		if (valid)
+		{
+			VECTOR_CODEC_MEMCPY(&r.column_count, cursor, 4);
+			VECTOR_CODEC_MEMCPY(&r.rows_per_group, cursor + 8, 8);
+			VECTOR_CODEC_MEMCPY(&r.row_count, cursor + 16, 8);
+			cursor += Impl::TableHeaderSize;
+			valid = r.column_count != 0 && r.rows_per_group != 0 && r.column_count <= (size_t)(end - cursor) / 5 && r.row_count <= SIZE_MAX / 4;
+		}
+		if (valid)
+		{
+			r.group_count = r.row_count / r.rows_per_group + (r.row_count % r.rows_per_group != 0);
+			if (r.rows_per_group > r.row_count)
+				r.rows_per_group = r.row_count;
+			r.names.reserve(r.column_count);
+		}
+		for (uint32_t i = 0; i != r.column_count && valid; ++i)
+		{
+			uint32_t name_length;
+			valid = end - cursor >= 4;
+			if (valid)
+			{
+				VECTOR_CODEC_MEMCPY(&name_length, cursor, 4);
+				cursor += 4;
+				valid = (uint64_t)(end - cursor) > name_length && cursor[name_length] == 0;
+			}
+			if (valid)
+			{
+				r.names.push_back((const char*)cursor);
+				cursor += name_length + 1;
+			}
+		}
+		valid = valid && r.group_count <= (uint64_t)(end - cursor) / Impl::TableChunkRecordSize / r.column_count &&
+			(uint64_t)(end - cursor) == r.group_count * r.column_count * Impl::TableChunkRecordSize;
+		if (valid)
+			r.chunks.resize((size_t)(r.group_count * r.column_count));
+		for (size_t i = 0; i != r.chunks.size(); ++i)
+		{
+			ColumnChunk& chunk = r.chunks[i];
+			VECTOR_CODEC_MEMCPY(&chunk.offset, cursor, 8);
+			VECTOR_CODEC_MEMCPY(&chunk.size, cursor + 8, 8);
+			VECTOR_CODEC_MEMCPY(&chunk.nan_count, cursor + 16, 8);
+			VECTOR_CODEC_MEMCPY(&chunk.min, cursor + 24, 4);
+			VECTOR_CODEC_MEMCPY(&chunk.max, cursor + 28, 4);
+			VECTOR_CODEC_MEMCPY(&chunk.checksum, cursor + 32, 4);
+			cursor += Impl::TableChunkRecordSize;
+			valid = chunk.offset >= 4 && chunk.offset <= metadata_offset && chunk.size != 0 && chunk.size <= metadata_offset - chunk.offset;
+			if (!valid)
+				break;
+			chunk.codec = (Format)r.base[chunk.offset];
+			valid = chunk.codec <= Format::Downcast && chunk.size - 1 >= Impl::MinimumSize(chunk.codec, r.GroupRowCount(i / r.column_count));
+			if (!valid)
+				break;
+		}
+		VECTOR_CODEC_UNLIKELY_IF(!valid)
+			r.Close();
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	uint32_t Table::FindColumn(const char* name) const noexcept
+	{
+		uint32_t i = 0;
+		while (i != column_count && std::strcmp(names[i], name) != 0)
+			++i;
+		return i;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool Table::MayMatch(uint64_t group, const RangeFilter* filters, size_t filter_count) const noexcept
+	{
+		for (size_t i = 0; i != filter_count; ++i)
+		{
+			VECTOR_CODEC_INVARIANT(filters[i].column < column_count);
+			const ColumnChunk& chunk = Chunk(group, filters[i].column);
+			if (!(chunk.max >= filters[i].low && chunk.min <= filters[i].high))
+				return false;
+		}
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool Table::ReadChunk(uint64_t group, uint32_t column, float* out) const noexcept
+	{
+		const ColumnChunk& chunk = Chunk(group, column);
+		VECTOR_CODEC_UNLIKELY_IF(Impl::Checksum(base + chunk.offset, (size_t)chunk.size) != chunk.checksum)
+			return false;
+		DecodeAuto(base + chunk.offset, GroupRowCount(group), out);
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void Table::Close() noexcept
+	{
+		if (base != nullptr)
+			Impl::UnmapFile(base, size, mapping);
+		base = nullptr;
+		size = 0;
+		mapping = nullptr;
+		row_count = 0;
+		rows_per_group = 0;
+		group_count = 0;
+		column_count = 0;
+		names.clear();
+		chunks.clear();
+	}
+
+	struct SegmentedLog::File
+	{
+		enum Mode
+		{
+			ForAppend,
+			ForWrite,
+			ForRead,
+		};
+
+#ifdef _WIN32
+		HANDLE handle = INVALID_HANDLE_VALUE;
+
+		~File()
+		{
+			CloseHandle(handle);
+		}
+
+		static std::shared_ptr<File> Open(const char* path, Mode mode)
+		{
+			const DWORD access = GENERIC_READ | (mode == ForAppend ? FILE_APPEND_DATA : mode == ForWrite ? GENERIC_WRITE : 0);
+			const DWORD disposition = mode == ForAppend ? OPEN_ALWAYS : mode == ForWrite ? CREATE_ALWAYS : OPEN_EXISTING;
+			const HANDLE handle = CreateFileA(path, access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+			VECTOR_CODEC_UNLIKELY_IF(handle == INVALID_HANDLE_VALUE)
+				return nullptr;
+			auto r = std::make_shared<File>();
+			r->handle = handle;
+			return r;
+		}
+
+		bool Write(const void* data, size_t size) noexcept
+		{
+			for (DWORD n; size != 0; data = (const uint8_t*)data + n, size -= n)
+			{
+				VECTOR_CODEC_UNLIKELY_IF(!WriteFile(handle, data, size < (1U << 30) ? (DWORD)size : (1U << 30), &n, nullptr) || n == 0)
+					return false;
+			}
+			return true;
+		}
+
+		bool Read(uint64_t offset, size_t size, void* out) const noexcept
+		{
+			for (DWORD n; size != 0; offset += n, out = (uint8_t*)out + n, size -= n)
+			{
+				OVERLAPPED overlapped = {};
+				overlapped.Offset = (DWORD)offset;
+				overlapped.OffsetHigh = (DWORD)(offset >> 32);
+				VECTOR_CODEC_UNLIKELY_IF(!ReadFile(handle, out, size < (1U << 30) ? (DWORD)size : (1U << 30), &n, &overlapped) || n == 0)
+					return false;
+			}
+			return true;
+		}
+
+		bool Size(uint64_t& size) const noexcept
+		{
+			LARGE_INTEGER file_size;
+			VECTOR_CODEC_UNLIKELY_IF(!GetFileSizeEx(handle, &file_size))
+				return false;
+			size = (uint64_t)file_size.QuadPart;
+			return true;
+		}
+
+		bool Sync() noexcept
+		{
+			return FlushFileBuffers(handle) != 0;
+		}
+#else
+		int fd = -1;
+
+		~File()
+		{
+			close(fd);
+		}
+
+		static std::shared_ptr<File> Open(const char* path, Mode mode)
+		{
+			const int flags = mode == ForAppend ? O_RDWR | O_CREAT | O_APPEND : mode == ForWrite ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY;
+			const int fd = open(path, flags | O_CLOEXEC, 0644);
+			VECTOR_CODEC_UNLIKELY_IF(fd < 0)
+				return nullptr;
+			auto r = std::make_shared<File>();
+			r->fd = fd;
+			return r;
+		}
+
+		bool Write(const void* data, size_t size) noexcept
+		{
+			for (ssize_t n; size != 0; data = (const uint8_t*)data + n, size -= (size_t)n)
+			{
+				n = write(fd, data, size);
+				VECTOR_CODEC_UNLIKELY_IF(n <= 0)
+					return false;
+			}
+			return true;
+		}
+
+		bool Read(uint64_t offset, size_t size, void* out) const noexcept
+		{
+			for (ssize_t n; size != 0; offset += (uint64_t)n, out = (uint8_t*)out + n, size -= (size_t)n)
+			{
+				n = pread(fd, out, size, (off_t)offset);
+				VECTOR_CODEC_UNLIKELY_IF(n <= 0)
+					return false;
+			}
+			return true;
+		}
+
+		bool Size(uint64_t& size) const noexcept
+		{
+			struct stat info;
+			VECTOR_CODEC_UNLIKELY_IF(fstat(fd, &info) != 0)
+				return false;
+			size = (uint64_t)info.st_size;
+			return true;
+		}
+
+		bool Sync() noexcept
+		{
+			return fsync(fd) == 0;
+		}
+#endif
+	};
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	std::vector<char> SegmentedLog::SegmentPath(uint64_t id, bool compacted) const
+	{
+		std::vector<char> r(prefix.size() + 32);
+		std::snprintf(r.data(), r.size(), "%s.%llu.%s", prefix.data(), (unsigned long long)id, compacted ? "dat" : "log");
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	std::vector<char> SegmentedLog::ManifestPath(bool temporary) const
+	{
+		std::vector<char> r(prefix.size() + 16);
+		std::snprintf(r.data(), r.size(), "%s.manifest%s", prefix.data(), temporary ? ".tmp" : "");
+		return r;
+	}
+
+	// Log segment: a sequence of records, each made of the value count, the size and a checksum as 32-bit integers, then the data written
+	// by EncodeAuto. The checksum covers the data followed by the count and the size, so a corrupted header is caught too; the runs keep the
+	// checksum of the data alone, like the chunks of a compacted segment. A record that is cut short or does not match its checksum ends the segment.
+	// Compacted segment: the magic number, the chunks written by EncodeAuto, an index record per chunk with its offset, size, value count and checksum,
+	// then a footer with the index offset, the chunk count, the checksum of the index and the magic number.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	std::shared_ptr<const SegmentedLog::Segment> SegmentedLog::LoadSegment(uint64_t id, bool compacted, uint64_t first) const
+	{
+		auto r = std::make_shared<Segment>();
+		r->id = id;
+		r->first = first;
+		r->compacted = compacted;
+		r->file = File::Open(SegmentPath(id, compacted).data(), File::ForRead);
+		uint64_t size = 0;
+		VECTOR_CODEC_UNLIKELY_IF(r->file == nullptr || !r->file->Size(size))
+			return nullptr;
+		std::vector<uint8_t> data;
+		if (!compacted)
+		{
+			data.resize((size_t)size);
+			VECTOR_CODEC_UNLIKELY_IF(size != 0 && !r->file->Read(0, (size_t)size, data.data()))
+				return nullptr;
+			for (uint64_t offset = 0; size - offset >= Impl::LogRecordHeaderSize;)
+			{
+				uint32_t header[3];
+				VECTOR_CODEC_MEMCPY(header, data.data() + offset, Impl::LogRecordHeaderSize);
+				const uint8_t* const record = data.data() + offset + Impl::LogRecordHeaderSize;
+				if (header[0] == 0 || header[1] == 0 || header[1] > size - offset - Impl::LogRecordHeaderSize || record[0] > (uint8_t)Format::Downcast)
+					break;
+				const uint32_t checksum = Impl::Checksum(record, header[1]);
+				if (Impl::Checksum(data.data() + offset, 8, checksum) != header[2])
+					break;
+				r->runs.push_back({ first + r->value_count, offset + Impl::LogRecordHeaderSize, header[1], header[0], checksum });
+				r->value_count += header[0];
+				offset += Impl::LogRecordHeaderSize + header[1];
+			}
+			return r;
+		}
+		uint8_t footer[Impl::LogFooterSize];
+		uint64_t index_offset = 0, run_count = 0;
+		uint32_t checksum = 0, magic = 0, head = 0;
+		bool valid = size >= 4 + Impl::LogFooterSize && r->file->Read(0, 4, &head) && r->file->Read(size - Impl::LogFooterSize, Impl::LogFooterSize, footer);
+		if (valid)
+		{
+			VECTOR_CODEC_MEMCPY(&index_offset, footer, 8);
+			VECTOR_CODEC_MEMCPY(&run_count, footer + 8, 8);
+			VECTOR_CODEC_MEMCPY(&checksum, footer + 16, 4);
+			VECTOR_CODEC_MEMCPY(&magic, footer + 20, 4);
+			const uint64_t limit = size - Impl::LogFooterSize;
+			valid = head == Impl::LogSegmentMagic && magic == Impl::LogSegmentMagic && index_offset >= 4 && index_offset <= limit &&
+				run_count == (limit - index_offset) / Impl::LogIndexRecordSize && (limit - index_offset) % Impl::LogIndexRecordSize == 0;
+		}
+		if (valid)
+		{
+			data.resize((size_t)(run_count * Impl::LogIndexRecordSize));
+			valid = (data.empty() || r->file->Read(index_offset, data.size(), data.data())) && Impl::Checksum(data.data(), data.size()) == checksum;
+		}
+		for (uint64_t i = 0; i != run_count && valid; ++i)
+		{
+			Run run;
+			const uint8_t* const record = data.data() + i * Impl::LogIndexRecordSize;
+			VECTOR_CODEC_MEMCPY(&run.offset, record, 8);
+			VECTOR_CODEC_MEMCPY(&run.size, record + 8, 8);
+			VECTOR_CODEC_MEMCPY(&run.count, record + 16, 4);
+			VECTOR_CODEC_MEMCPY(&run.checksum, record + 20, 4);
+			run.first = first + r->value_count;
+			valid = run.offset >= 4 && run.offset <= index_offset && run.size != 0 && run.size <= index_offset - run.offset && run.count != 0;
+			r->runs.push_back(run);
+			r->value_count += run.count;
+		}
+		VECTOR_CODEC_UNLIKELY_IF(!valid)
+			return nullptr;
+		return r;
+	}
+
+	// Manifest: the magic number, a reserved word and the segment count, then each segment as its id shifted left by one, with the low bit set
+	// for compacted segments, followed by the checksum of everything before it. The active segment comes last.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::WriteManifest(const std::vector<std::shared_ptr<const Segment>>& list) const
+	{
+		std::vector<uint8_t> data(16 + (list.size() + 1) * 8 + 4);
+		const uint32_t magic = Impl::LogManifestMagic;
+		const uint64_t count = list.size() + 1;
+		VECTOR_CODEC_MEMCPY(data.data(), &magic, 4);
+		VECTOR_CODEC_MEMCPY(data.data() + 8, &count, 8);
+		for (size_t i = 0; i != list.size(); ++i)
+		{
+			const uint64_t entry = list[i]->id << 1 | (uint64_t)list[i]->compacted;
+			VECTOR_CODEC_MEMCPY(data.data() + 16 + i * 8, &entry, 8);
+		}
+		const uint64_t entry = active_id << 1;
+		VECTOR_CODEC_MEMCPY(data.data() + 16 + list.size() * 8, &entry, 8);
+		const uint32_t checksum = Impl::Checksum(data.data(), data.size() - 4);
+		VECTOR_CODEC_MEMCPY(data.data() + data.size() - 4, &checksum, 4);
+		const auto temporary = ManifestPath(true);
+		{
+			const auto file = File::Open(temporary.data(), File::ForWrite);
+			VECTOR_CODEC_UNLIKELY_IF(file == nullptr || !file->Write(data.data(), data.size()) || !file->Sync())
+				return false;
+		}
+		return Impl::RenameFile(temporary.data(), ManifestPath(false).data());
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::Open(const char* path, size_t segment_bytes, size_t chunk_values, uint32_t compact_segments)
+	{
+		VECTOR_CODEC_INVARIANT(segment_bytes != 0 && chunk_values != 0 && chunk_values <= (1U << 28) && compact_segments != 0);
+		(void)Close();
+		prefix.assign(path, path + std::strlen(path) + 1);
+		this->segment_bytes = segment_bytes;
+		this->chunk_values = chunk_values;
+		this->compact_segments = compact_segments;
+		next_id = 0;
+		const auto manifest = File::Open(ManifestPath(false).data(), File::ForRead);
+		bool valid = true;
+		if (manifest != nullptr)
+		{
+			uint64_t size = 0, count = 0;
+			uint32_t magic = 0, checksum = 0;
+			std::vector<uint8_t> data;
+			valid = manifest->Size(size) && size >= 20 && (size - 20) % 8 == 0;
+			if (valid)
+			{
+				data.resize((size_t)size);
+				valid = manifest->Read(0, data.size(), data.data());
+			}
+			if (valid)
+			{
+				VECTOR_CODEC_MEMCPY(&magic, data.data(), 4);
+				VECTOR_CODEC_MEMCPY(&count, data.data() + 8, 8);
+				VECTOR_CODEC_MEMCPY(&checksum, data.data() + data.size() - 4, 4);
+				valid = magic == Impl::LogManifestMagic && count == (size - 20) / 8 && Impl::Checksum(data.data(), data.size() - 4) == checksum;
+			}
+			for (uint64_t i = 0; i != count && valid; ++i)
+			{
+				uint64_t entry;
+				VECTOR_CODEC_MEMCPY(&entry, data.data() + 16 + i * 8, 8);
+				auto segment = LoadSegment(entry >> 1, (entry & 1) != 0, value_count);
+				valid = segment != nullptr;
+				if (!valid)
+					break;
+				value_count += segment->value_count;
+				sealed_count += !segment->compacted;
+				if (next_id <= segment->id)
+					next_id = segment->id + 1;
+				segments.push_back(std::move(segment));
+			}
+		}
+		if (valid)
+		{
+			active_id = next_id++;
+			active_first = value_count;
+			active_bytes = 0;
+			active = File::Open(SegmentPath(active_id, false).data(), File::ForAppend);
+			valid = active != nullptr && WriteManifest(segments);
+		}
+		VECTOR_CODEC_UNLIKELY_IF(!valid)
+		{
+			(void)Close();
+			return false;
+		}
+		compactor = std::thread([this] { CompactLoop(); });
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::Append(const float* values, size_t value_count)
+	{
+		VECTOR_CODEC_UNLIKELY_IF(active == nullptr || failed)
+			return false;
+		for (size_t done = 0; done != value_count;)
+		{
+			const size_t n = value_count - done < chunk_values ? value_count - done : chunk_values;
+			buffer.resize(Impl::LogRecordHeaderSize + UpperBoundAuto(n));
+			const size_t k = EncodeAuto(values + done, n, buffer.data() + Impl::LogRecordHeaderSize);
+			const uint32_t checksum = Impl::Checksum(buffer.data() + Impl::LogRecordHeaderSize, k);
+			uint32_t header[3] = { (uint32_t)n, (uint32_t)k, 0 };
+			header[2] = Impl::Checksum((const uint8_t*)header, 8, checksum);
+			VECTOR_CODEC_MEMCPY(buffer.data(), header, Impl::LogRecordHeaderSize);
+			// One write per record: O_APPEND keeps it in one piece at the end of the file.
+			VECTOR_CODEC_UNLIKELY_IF(k == 0 || !active->Write(buffer.data(), Impl::LogRecordHeaderSize + k))
+			{
+				failed = true;
+				return false;
+			}
+			std::lock_guard<std::mutex> guard(mutex);
+			active_runs.push_back({ this->value_count, active_bytes + Impl::LogRecordHeaderSize, k, (uint32_t)n, checksum });
+			this->value_count += n;
+			active_bytes += Impl::LogRecordHeaderSize + k;
+			done += n;
+			VECTOR_CODEC_UNLIKELY_IF(active_bytes >= segment_bytes && !Roll())
+			{
+				failed = true;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Called with the mutex held.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::Roll()
+	{
+		auto file = File::Open(SegmentPath(next_id, false).data(), File::ForAppend);
+		VECTOR_CODEC_UNLIKELY_IF(file == nullptr)
+			return false;
+		auto sealed = std::make_shared<Segment>();
+		sealed->id = active_id;
+		sealed->first = active_first;
+		sealed->value_count = value_count - active_first;
+		sealed->file = std::move(active);
+		sealed->runs = std::move(active_runs);
+		segments.push_back(std::move(sealed));
+		active = std::move(file);
+		active_runs.clear();
+		active_id = next_id++;
+		active_first = value_count;
+		active_bytes = 0;
+		++sealed_count;
+		VECTOR_CODEC_UNLIKELY_IF(!WriteManifest(segments))
+			return false;
+		if (sealed_count >= compact_segments)
+			wake.notify_one();
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::ReadRun(const File& file, const Run& run, std::vector<uint8_t>& compressed, float* out)
+	{
+		compressed.resize((size_t)run.size + Impl::LogDecodePadding);
+		VECTOR_CODEC_UNLIKELY_IF(!file.Read(run.offset, (size_t)run.size, compressed.data()) || Impl::Checksum(compressed.data(), (size_t)run.size) != run.checksum)
+			return false;
+		DecodeAuto(compressed.data(), run.count, out);
+		return true;
+	}
+
+	// Only compactions remove segments and they are serialized, so the inputs are still in place when the result is swapped in,
+	// possibly followed by segments sealed in the meantime.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::Compact()
+	{
+		std::lock_guard<std::mutex> compacting(compact_mutex);
+		std::vector<std::shared_ptr<const Segment>> inputs;
+		auto result = std::make_shared<Segment>();
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			VECTOR_CODEC_UNLIKELY_IF(active == nullptr)
+				return false;
+			size_t first = 0;
+			while (first != segments.size() && segments[first]->compacted)
+				++first;
+			if (first == segments.size())
+				return true;
+			// A compacted segment that does not fill a chunk yet is merged again, so compacted segments end up holding at least a chunk each.
+			if (first != 0 && segments[first - 1]->value_count < chunk_values)
+				--first;
+			inputs.assign(segments.begin() + first, segments.end());
+			result->id = next_id++;
+		}
+		result->first = inputs[0]->first;
+		result->compacted = true;
+		const auto path = SegmentPath(result->id, true);
+		result->file = File::Open(path.data(), File::ForWrite);
+		const uint32_t magic = Impl::LogSegmentMagic;
+		bool valid = result->file != nullptr && result->file->Write(&magic, 4);
+		uint64_t offset = 4;
+		std::vector<float> chunk, values;
+		std::vector<uint8_t> compressed, index;
+		chunk.reserve(chunk_values);
+		const auto flush = [&]
+		{
+			if (!valid || chunk.empty())
+				return;
+			compressed.resize(UpperBoundAuto(chunk.size()));
+			const size_t k = EncodeAuto(chunk.data(), chunk.size(), compressed.data());
+			valid = k != 0 && result->file->Write(compressed.data(), k);
+			const Run run = { result->first + result->value_count, offset, k, (uint32_t)chunk.size(), Impl::Checksum(compressed.data(), k) };
+			uint8_t record[Impl::LogIndexRecordSize];
+			VECTOR_CODEC_MEMCPY(record, &run.offset, 8);
+			VECTOR_CODEC_MEMCPY(record + 8, &run.size, 8);
+			VECTOR_CODEC_MEMCPY(record + 16, &run.count, 4);
+			VECTOR_CODEC_MEMCPY(record + 20, &run.checksum, 4);
+			index.insert(index.end(), record, record + sizeof(record));
+			result->runs.push_back(run);
+			result->value_count += chunk.size();
+			offset += k;
+			chunk.clear();
+		};
+		for (const auto& segment : inputs)
+		{
+			for (const Run& run : segment->runs)
+			{
+				values.resize(run.count);
+				valid = valid && ReadRun(*segment->file, run, compressed, values.data());
+				for (size_t i = 0; i != run.count && valid;)
 				{
-					VECTOR_CODEC_UNLIKELY_IF(value_count != 0)
-						VECTOR_CODEC_MEMCPY(out, &vec, value_count << 2);
-					_mm256_zeroall();
-					return;
+					const size_t n = chunk_values - chunk.size() < run.count - i ? chunk_values - chunk.size() : run.count - i;
+					chunk.insert(chunk.end(), values.data() + i, values.data() + i + n);
+					i += n;
+					if (chunk.size() == chunk_values)
+						flush();
 				}
-				_mm256_storeu_si256((__m256i*)out, vec);
-				prior = vec;
-				value_count -= 8;
-				out += 8;
 			}
 		}
+		flush();
+		uint8_t footer[Impl::LogFooterSize];
+		const uint64_t run_count = result->runs.size();
+		const uint32_t checksum = Impl::Checksum(index.data(), index.size());
+		VECTOR_CODEC_MEMCPY(footer, &offset, 8);
+		VECTOR_CODEC_MEMCPY(footer + 8, &run_count, 8);
+		VECTOR_CODEC_MEMCPY(footer + 16, &checksum, 4);
+		VECTOR_CODEC_MEMCPY(footer + 20, &magic, 4);
+		valid = valid && (index.empty() || result->file->Write(index.data(), index.size())) && result->file->Write(footer, sizeof(footer)) && result->file->Sync();
+		if (valid)
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			const auto begin = std::find(segments.begin(), segments.end(), inputs[0]);
+			std::vector<std::shared_ptr<const Segment>> list(segments.begin(), begin);
+			if (result->value_count != 0)
+				list.push_back(result);
+			list.insert(list.end(), begin + inputs.size(), segments.end());
+			valid = WriteManifest(list);
+			if (valid)
+			{
+				segments.swap(list);
+				sealed_count -= inputs.size() - (size_t)inputs[0]->compacted;
+				caught_up.notify_all();
+			}
+		}
+		if (!valid || result->value_count == 0)
+		{
+			result->file.reset();
+			std::remove(path.data());
+		}
+		if (valid)
+			for (const auto& segment : inputs)
+				std::remove(SegmentPath(segment->id, segment->compacted).data());
+		return valid;
 	}
 
 #ifdef VECTOR_CODEC_INLINE
-	VECTOR_CODEC_INLINE_ALWAYS static
+	VECTOR_CODEC_INLINE_ALWAYS inline
 #endif
-	size_t VECTOR_CODEC_CALL Encode(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	void SegmentedLog::CompactLoop()
 	{
-		return Impl::Encode_AVX2(values, value_count, out);
+		std::unique_lock<std::mutex> guard(mutex);
+		for (;;)
+		{
+			wake.wait(guard, [&] { return stopping || sealed_count >= compact_segments; });
+			if (stopping)
+				return;
+			guard.unlock();
+			const bool compacted = Compact();
+			guard.lock();
+			compact_failed = !compacted;
+			caught_up.notify_all();
+			// Retries a failed compaction later rather than spinning on the same error.
+			if (!compacted)
+				wake.wait_for(guard, std::chrono::seconds(1), [&] { return stopping; });
+		}
 	}
 
 #ifdef VECTOR_CODEC_INLINE
-	VECTOR_CODEC_INLINE_ALWAYS static
+	VECTOR_CODEC_INLINE_ALWAYS inline
 #endif
-	void VECTOR_CODEC_CALL Decode(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	bool SegmentedLog::WaitForCompaction()
 	{
-		Impl::Decode_AVX2(compressed, value_count, out);
+		std::unique_lock<std::mutex> guard(mutex);
+		caught_up.wait(guard, [&] { return stopping || active == nullptr || compact_failed || sealed_count < compact_segments; });
+		return !stopping && active != nullptr && !compact_failed && sealed_count < compact_segments;
 	}
 
 #ifdef VECTOR_CODEC_INLINE
-	VECTOR_CODEC_INLINE_ALWAYS static
+	VECTOR_CODEC_INLINE_ALWAYS inline
 #endif
-	size_t VECTOR_CODEC_CALL EncodeQuick(const float* VECTOR_CODEC_RESTRICT values, size_t value_count, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept
+	SegmentedLog::Snapshot SegmentedLog::TakeSnapshot() const
 	{
-		return Impl::EncodeQuick_AVX2(values, value_count, out);
+		Snapshot r;
+		std::lock_guard<std::mutex> guard(mutex);
+		r.segments = segments;
+		if (!active_runs.empty())
+		{
+			auto tail = std::make_shared<Segment>();
+			tail->id = active_id;
+			tail->first = active_first;
+			tail->value_count = value_count - active_first;
+			tail->file = active;
+			tail->runs = active_runs;
+			r.segments.push_back(std::move(tail));
+		}
+		r.value_count = value_count;
+		return r;
 	}
 
 #ifdef VECTOR_CODEC_INLINE
-	VECTOR_CODEC_INLINE_ALWAYS static
+	VECTOR_CODEC_INLINE_ALWAYS inline
 #endif
-	void VECTOR_CODEC_CALL DecodeQuick(const uint8_t* VECTOR_CODEC_RESTRICT compressed, size_t value_count, float* VECTOR_CODEC_RESTRICT out) noexcept
+	bool SegmentedLog::Snapshot::Read(uint64_t first, size_t count, float* out) const
+	{
+		VECTOR_CODEC_UNLIKELY_IF(first > value_count || count > value_count - first)
+			return false;
+		if (count == 0)
+			return true;
+		const uint64_t end = first + count;
+		std::vector<uint8_t> compressed;
+		std::vector<float> values;
+		auto segment = std::upper_bound(segments.begin(), segments.end(), first, [](uint64_t index, const std::shared_ptr<const Segment>& s) { return index < s->first; });
+		for (--segment; first != end; ++segment)
+		{
+			const auto& runs = (*segment)->runs;
+			if (runs.empty())
+				continue;
+			auto run = std::upper_bound(runs.begin(), runs.end(), first, [](uint64_t index, const Run& r) { return index < r.first; }) - 1;
+			for (; run != runs.end() && first != end; ++run)
+			{
+				const uint64_t skip = first - run->first;
+				const size_t n = (size_t)(run->count - skip < end - first ? run->count - skip : end - first);
+				if (n == run->count)
+				{
+					VECTOR_CODEC_UNLIKELY_IF(!ReadRun(*(*segment)->file, *run, compressed, out))
+						return false;
+				}
+				else
+				{
+					values.resize(run->count);
+					VECTOR_CODEC_UNLIKELY_IF(!ReadRun(*(*segment)->file, *run, compressed, values.data()))
+						return false;
+					VECTOR_CODEC_MEMCPY(out, values.data() + skip, n * 4);
+				}
+				out += n;
+				first += n;
+			}
+		}
+		return true;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	uint64_t SegmentedLog::ValueCount() const noexcept
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		return value_count;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	size_t SegmentedLog::SegmentCount() const noexcept
 	{
-		Impl::DecodeQuick_AVX2(compressed, value_count, out);
+		std::lock_guard<std::mutex> guard(mutex);
+		return segments.size() + (active != nullptr);
 	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool SegmentedLog::Close() noexcept
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		caught_up.notify_all();
+		if (compactor.joinable())
+			compactor.join();
+		const bool r = !failed;
+		segments.clear();
+		active.reset();
+		active_runs.clear();
+		value_count = 0;
+		sealed_count = 0;
+		stopping = false;
+		failed = false;
+		compact_failed = false;
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	FrameRing FrameRing::Create(const char* name, uint32_t slot_count, size_t max_values)
+	{
+		VECTOR_CODEC_INVARIANT(slot_count != 0 && max_values != 0 && max_values <= UINT32_MAX);
+		FrameRing r;
+		const uint64_t slot_stride = (sizeof(Slot) + UpperBound(max_values) + DecodePadding + 63) & ~(uint64_t)63;
+		const uint64_t size = sizeof(Header) + slot_count * slot_stride;
+#ifdef _WIN32
+		HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, name);
+		VECTOR_CODEC_UNLIKELY_IF(handle == nullptr)
+			return r;
+		void* const view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		VECTOR_CODEC_UNLIKELY_IF(view == nullptr)
+		{
+			CloseHandle(handle);
+			return r;
+		}
+		r.mapping = handle;
+#else
+		// Consumers still attached to a previous ring keep it, rather than seeing this one being initialized.
+		(void)shm_unlink(name);
+		const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+		VECTOR_CODEC_UNLIKELY_IF(fd < 0)
+			return r;
+		void* const view = ftruncate(fd, (off_t)size) == 0 ? mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		VECTOR_CODEC_UNLIKELY_IF(view == MAP_FAILED)
+		{
+			(void)shm_unlink(name);
+			return r;
+		}
+#endif
+		r.base = (uint8_t*)view;
+		r.size = (size_t)size;
+		Header* const header = new (r.base) Header();
+		header->slot_count = slot_count;
+		header->slot_stride = slot_stride;
+		header->max_values = max_values;
+		header->head.store(0, std::memory_order_relaxed);
+		for (uint32_t i = 0; i != slot_count; ++i)
+			new (r.slot(i)) Slot();
+		header->magic.store(Magic, std::memory_order_release);
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	FrameRing FrameRing::Attach(const char* name)
+	{
+		FrameRing r;
+#ifdef _WIN32
+		HANDLE handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+		VECTOR_CODEC_UNLIKELY_IF(handle == nullptr)
+			return r;
+		void* const view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+		MEMORY_BASIC_INFORMATION info;
+		VECTOR_CODEC_UNLIKELY_IF(view == nullptr || VirtualQuery(view, &info, sizeof(info)) == 0)
+		{
+			if (view != nullptr)
+				UnmapViewOfFile(view);
+			CloseHandle(handle);
+			return r;
+		}
+		r.base = (uint8_t*)view;
+		r.size = info.RegionSize;
+		r.mapping = handle;
+#else
+		const int fd = shm_open(name, O_RDONLY, 0);
+		VECTOR_CODEC_UNLIKELY_IF(fd < 0)
+			return r;
+		struct stat info;
+		void* const view = fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(Header) ? mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+		close(fd);
+		VECTOR_CODEC_UNLIKELY_IF(view == MAP_FAILED)
+			return r;
+		r.base = (uint8_t*)view;
+		r.size = (size_t)info.st_size;
+#endif
+		const Header* const header = r.header();
+		VECTOR_CODEC_UNLIKELY_IF(r.size < sizeof(Header) || header->magic.load(std::memory_order_acquire) != Magic || header->slot_count == 0 ||
+			header->slot_stride < sizeof(Slot) + UpperBound(header->max_values) || header->slot_stride > (r.size - sizeof(Header)) / header->slot_count)
+			r.Close();
+		return r;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool FrameRing::Remove(const char* name) noexcept
+	{
+#ifdef _WIN32
+		(void)name;
+		return true;
+#else
+		return shm_unlink(name) == 0;
+#endif
+	}
+
+	// A single producer owns the head, so it is only read back here and not updated with a read-modify-write.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void FrameRing::Publish(const float* values, size_t value_count, uint64_t timestamp, Format format) noexcept
+	{
+		VECTOR_CODEC_INVARIANT(value_count <= header()->max_values && (format == Format::Default || format == Format::Quick));
+		const uint64_t sequence = header()->head.load(std::memory_order_relaxed);
+		Slot* const target = slot(sequence);
+		target->version.store(2 * sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		uint8_t* const compressed = (uint8_t*)(target + 1);
+		target->timestamp = timestamp;
+		target->value_count = (uint32_t)value_count;
+		target->format = format;
+		target->compressed_size = (uint32_t)(format == Format::Quick ? EncodeQuick(values, value_count, compressed) : Encode(values, value_count, compressed));
+		target->version.store(2 * sequence + 2, std::memory_order_release);
+		header()->head.store(sequence + 1, std::memory_order_release);
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	FrameStatus FrameRing::Begin(uint64_t sequence, FrameInfo& info, const uint8_t*& compressed) const noexcept
+	{
+		const uint64_t head = Head();
+		if (sequence >= head)
+			return FrameStatus::NotPublished;
+		VECTOR_CODEC_UNLIKELY_IF(head - sequence > header()->slot_count)
+			return FrameStatus::Overwritten;
+		const Slot* const source = slot(sequence);
+		VECTOR_CODEC_UNLIKELY_IF(source->version.load(std::memory_order_acquire) != 2 * sequence + 2)
+			return FrameStatus::Overwritten;
+		info.sequence = sequence;
+		info.timestamp = source->timestamp;
+		info.value_count = source->value_count;
+		info.compressed_size = source->compressed_size;
+		info.format = source->format;
+		compressed = (const uint8_t*)(source + 1);
+		// The metadata must be consistent before it is used to size the decoding.
+		VECTOR_CODEC_UNLIKELY_IF(!Validate(sequence))
+			return FrameStatus::Overwritten;
+		return FrameStatus::Ready;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	bool FrameRing::Validate(uint64_t sequence) const noexcept
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot(sequence)->version.load(std::memory_order_relaxed) == 2 * sequence + 2;
+	}
+
+	// A torn slot can only hold garbage residuals: the decoder never reads more than UpperBound(value_count) bytes plus its padding, which the slot
+	// has room for, and the result is thrown away by the final check.
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	FrameStatus FrameRing::Read(uint64_t sequence, float* out, FrameInfo& info) const noexcept
+	{
+		const uint8_t* compressed;
+		const FrameStatus status = Begin(sequence, info, compressed);
+		if (status != FrameStatus::Ready)
+			return status;
+		if (info.format == Format::Quick)
+			DecodeQuick(compressed, info.value_count, out);
+		else
+			Decode(compressed, info.value_count, out);
+		return Validate(sequence) ? FrameStatus::Ready : FrameStatus::Overwritten;
+	}
+
+#ifdef VECTOR_CODEC_INLINE
+	VECTOR_CODEC_INLINE_ALWAYS inline
+#endif
+	void FrameRing::Close() noexcept
+	{
+		if (base != nullptr)
+			Impl::UnmapFile(base, size, mapping);
+		base = nullptr;
+		size = 0;
+		mapping = nullptr;
+	}
+
+#ifndef VECTOR_CODEC_INLINE
+	template size_t VECTOR_CODEC_CALL Encode<16>(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+	template size_t VECTOR_CODEC_CALL Encode<32>(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+	template size_t VECTOR_CODEC_CALL Encode<64>(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+	template size_t VECTOR_CODEC_CALL Encode<128>(const float* VECTOR_CODEC_RESTRICT values, uint8_t* VECTOR_CODEC_RESTRICT out) noexcept;
+	template void VECTOR_CODEC_CALL Decode<16>(const uint8_t* VECTOR_CODEC_RESTRICT compressed, float* VECTOR_CODEC_RESTRICT out) noexcept;
+	template void VECTOR_CODEC_CALL Decode<32>(const uint8_t* VECTOR_CODEC_RESTRICT compressed, float* VECTOR_CODEC_RESTRICT out) noexcept;
+	template void VECTOR_CODEC_CALL Decode<64>(const uint8_t* VECTOR_CODEC_RESTRICT compressed, float* VECTOR_CODEC_RESTRICT out) noexcept;
+	template void VECTOR_CODEC_CALL Decode<128>(const uint8_t* VECTOR_CODEC_RESTRICT compressed, float* VECTOR_CODEC_RESTRICT out) noexcept;
+#endif
 }
 #undef VECTOR_CODEC_BSWAP_IF_BE
+#undef VECTOR_CODEC_BSWAP16_IF_BE
 #undef VECTOR_CODEC_INLINE_ALWAYS
 #undef VECTOR_CODEC_UNLIKELY_IF
 #undef VECTOR_CODEC_INVARIANT
 #undef VECTOR_CODEC_CLZ
+#undef VECTOR_CODEC_POPCNT
+#undef VECTOR_CODEC_CTZ
 #undef VECTOR_CODEC_MEMCPY
+#ifdef VECTOR_CODEC_AVX512VL
+#undef VECTOR_CODEC_AVX512VL
+#endif
+#ifdef VECTOR_CODEC_BMI2
+#undef VECTOR_CODEC_BMI2
+#endif
+#ifdef VECTOR_CODEC_F16C
+#undef VECTOR_CODEC_F16C
+#endif
 #endif
 
 #ifdef VECTOR_CODEC_RESTRICT